@@ -0,0 +1,82 @@
+# Convert the records collected by `make run` into JSON or CSV.
+#
+# Each input line is one run: space-separated key=value fields, e.g.
+#   bench=mcf input=ref status=pass time_us=1234 size=3 cycles=5678
+# Usage: awk -f result.awk -v format=json|csv [-v time=... -v arch=...] FILE
+# A key repeated within a line keeps its first value. CSV columns are the
+# union of all keys in order of first appearance.
+
+function quote(v) {
+  gsub(/\\/, "\\\\", v)
+  gsub(/"/, "\\\"", v)
+  return "\"" v "\""
+}
+
+function json_value(v) {
+  return v ~ /^-?[0-9]+(\.[0-9]+)?$/ ? v : quote(v)
+}
+
+function csv_value(v) {
+  if (v ~ /[",]/) {
+    gsub(/"/, "\"\"", v)
+    v = "\"" v "\""
+  }
+  return v
+}
+
+{
+  nrec++
+  for (i = 1; i <= NF; i++) {
+    eq = index($i, "=")
+    if (eq == 0)
+      continue
+    k = substr($i, 1, eq - 1)
+    v = substr($i, eq + 1)
+    if ((nrec, k) in val)
+      continue
+    val[nrec, k] = v
+    nkeys[nrec]++
+    order[nrec, nkeys[nrec]] = k
+    if (k == "ratio" && v > 0) {
+      nratio++
+      logsum += log(v)
+    }
+    if (!(k in seen)) {
+      seen[k] = 1
+      cols[++ncols] = k
+    }
+  }
+}
+
+END {
+  if (format == "csv") {
+    line = ""
+    for (c = 1; c <= ncols; c++)
+      line = line (c > 1 ? "," : "") csv_value(cols[c])
+    print line
+    for (r = 1; r <= nrec; r++) {
+      line = ""
+      for (c = 1; c <= ncols; c++)
+        line = line (c > 1 ? "," : "") \
+               ((r, cols[c]) in val ? csv_value(val[r, cols[c]]) : "")
+      print line
+    }
+    exit
+  }
+  print "{"
+  printf "  \"time\": %s,\n", quote(time)
+  printf "  \"arch\": %s,\n", quote(arch)
+  if (nratio)
+    printf "  \"score\": %.4f,\n", exp(logsum / nratio)
+  print "  \"results\": ["
+  for (r = 1; r <= nrec; r++) {
+    line = "    {"
+    for (j = 1; j <= nkeys[r]; j++) {
+      k = order[r, j]
+      line = line (j > 1 ? ", " : "") quote(k) ": " json_value(val[r, k])
+    }
+    print line (r < nrec ? "}," : "}")
+  }
+  print "  ]"
+  print "}"
+}
@@ -0,0 +1,43 @@
+# Add SPEC-style ratios to the records collected by `make run`.
+#
+# ratio = reference time / measured time, so a faster run scores higher. The
+# reference is time_us of the same benchmark and input in the CSV given with
+# -v ref=FILE (a result of an earlier `make run`) or, when there is none, the
+# record's ref_time_us (from the benchmark's Setting).
+# Usage: awk -f score.awk [-v ref=FILE] RECORDS
+
+function field(line, key,    re) {
+  re = "(^| )" key "=[^ ]*"
+  if (!match(line, re))
+    return ""
+  line = substr(line, RSTART, RLENGTH)
+  return substr(line, index(line, "=") + 1)
+}
+
+BEGIN {
+  if (ref != "") {
+    FS = ","
+    while ((getline line < ref) > 0) {
+      n = split(line, f, ",")
+      if (!header++) {
+        for (i = 1; i <= n; i++)
+          col[f[i]] = i
+        continue
+      }
+      if (f[col["status"]] == "pass" && f[col["time_us"]] > 0)
+        ref_us[f[col["bench"]], f[col["input"]]] = f[col["time_us"]]
+    }
+    close(ref)
+    FS = " "
+  }
+}
+
+{
+  time = field($0, "time_us")
+  r = ref_us[field($0, "bench"), field($0, "input")]
+  if (r == "")
+    r = field($0, "ref_time_us")
+  if (field($0, "status") == "pass" && time + 0 > 0 && r + 0 > 0)
+    $0 = $0 sprintf(" ratio=%.4f", r / time)
+  print
+}
@@ -20,7 +20,7 @@ char *format_time(uint64_t us) {
 
   int len = 0;
   if (h > 0) {
-    len = bench_sprintf(buf, "%lld h %lld min %lld s %lld.000 ms", h, min, s, ms);
+    len = bench_sprintf(buf, "%lld h %lld min %lld s, %lld.000 ms", h, min, s, ms);
   } else if (min > 0) {
     len = bench_sprintf(buf, "%lld min %lld s, %lld.000 ms", min, s, ms);
   } else if (s > 0) {
@@ -54,10 +54,8 @@ char *format_time(uint64_t us) {
 uint32_t checksum(void *start, void *end) {
   const uint32_t x = 16777619;
   uint32_t h1 = 2166136261u;
-  for (uint8_t *p = (uint8_t *)start; p + 4 < (uint8_t *)end; p += 4) {
-    for (int i = 0; i < 4; i++) {
-      h1 = (h1 ^ p[i]) * x;
-    }
+  for (uint8_t *p = (uint8_t *)start; p < (uint8_t *)end; p++) {
+    h1 = (h1 ^ *p) * x;
   }
   int32_t hash = (uint32_t)h1;
   hash += hash << 13;
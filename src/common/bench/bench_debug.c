@@ -34,8 +34,8 @@ static int skip_atoi(const char **s) {
   return i;
 }
 
-static char *number(char *str, long num, int base, int size, int precision,
-                    int type) {
+static char *number(char *str, long long num, int base, int size,
+                    int precision, int type) {
   char c, sign, tmp[66];
   const char *dig = digits;
   int i;
@@ -72,8 +72,8 @@ static char *number(char *str, long num, int base, int size, int precision,
     tmp[i++] = '0';
   else {
     while (num != 0) {
-      tmp[i++] = dig[((unsigned long)num) % (unsigned)base];
-      num = ((unsigned long)num) / (unsigned)base;
+      tmp[i++] = dig[((unsigned long long)num) % (unsigned)base];
+      num = ((unsigned long long)num) / (unsigned)base;
     }
   }
 
@@ -1,10 +1,30 @@
 #include <am.h>
+#include <bench.h>
+#include <bench_debug.h>
 #include <bench_malloc.h>
+#include <bench_mem.h>
 #include <klib.h>
 #include <stdint.h>
 
 static intptr_t program_break = 0;
 
+#ifdef BENCH_MALLOC_STATS
+static struct {
+  uint64_t malloc_calls, free_calls, realloc_calls, calloc_calls;
+  uint64_t bytes_requested;
+  uint64_t walk_steps; // free-list entries/bitmap words visited by malloc
+  uint64_t time_us;
+  size_t live;         // usable bytes of allocated blocks
+  intptr_t peak_break;
+  size_t live_at_peak;
+  int depth;
+  uint64_t start;
+} stats;
+#define STAT(stmt) stmt
+#else
+#define STAT(stmt)
+#endif
+
 static void *sbrk(intptr_t increment) {
   assert(program_break);
   intptr_t ret_addr = -1;
@@ -24,6 +44,8 @@ static inline size_t word_align(size_t size) {
   return (size + (sizeof(size_t) - 1)) & ~(sizeof(size_t) - 1);
 }
 
+#ifdef BENCH_MALLOC_FIRSTFIT
+
 struct chunk {
   struct chunk *next, *prev;
   size_t size;
@@ -33,8 +55,9 @@ struct chunk {
 
 typedef struct chunk *Chunk;
 
+static Chunk b = NULL;
+
 static void *malloc_base() {
-  static Chunk b = NULL;
   if (!b) {
     b = sbrk(word_align(sizeof(struct chunk)));
     if (b == (void *)-1) {
@@ -50,14 +73,15 @@ static void *malloc_base() {
   return b;
 }
 
-// We need this function because the variable `heap` is used
-// and initialized at runtime.
-void bench_malloc_init() { program_break = (intptr_t)heap.start; }
+static void heap_init() {
+  program_break = (intptr_t)heap.start;
+  b = NULL;
+}
 
 static Chunk malloc_chunk_find(size_t s, Chunk *heap) {
   Chunk c = malloc_base();
   for (; c && (!c->free || c->size < s); *heap = c, c = c->next)
-    ;
+    STAT(stats.walk_steps++);
   return c;
 }
 
@@ -83,7 +107,7 @@ static void malloc_split_next(Chunk c, size_t size) {
   c->size = size - sizeof(struct chunk);
 }
 
-void *bench_malloc(size_t size) {
+static void *do_malloc(size_t size) {
   if (!size)
     return NULL;
   size_t length = word_align(size + sizeof(struct chunk));
@@ -107,7 +131,7 @@ void *bench_malloc(size_t size) {
   return c->data;
 }
 
-void bench_free(void *ptr) {
+static void do_free(void *ptr) {
   if (!ptr || ptr < malloc_base() || ptr > sbrk(0))
     return;
   Chunk c = (Chunk)ptr - 1;
@@ -127,30 +151,391 @@ void bench_free(void *ptr) {
   }
 }
 
+static void *do_realloc(void *ptr, size_t size) {
+  void *newptr = do_malloc(size);
+  if (newptr && ptr && ptr >= malloc_base() && ptr <= sbrk(0)) {
+    Chunk c = (Chunk)ptr - 1;
+    if (c->data == ptr) {
+      bench_memcpy(newptr, ptr, c->size > size ? size : c->size);
+      do_free(ptr);
+    }
+  }
+  return newptr;
+}
+
+#ifdef BENCH_MALLOC_STATS
+static size_t do_usable_size(void *ptr) {
+  if (!ptr || ptr < malloc_base() || ptr > sbrk(0))
+    return 0;
+  Chunk c = (Chunk)ptr - 1;
+  return c->data == ptr && !c->free ? c->size : 0;
+}
+#endif
+
+#else
+
+// Size-class segregated allocator.
+//
+// Every block starts with a two-word header holding the size of the
+// physically previous block and its own payload size, so neighbours can be
+// found in O(1) and coalesced on free. Free blocks are kept in bins: requests
+// up to SMALL_MAX bytes have one exact-fit bin per ALIGN-sized class, larger
+// ones share power-of-two bins. A bitmap of non-empty bins lets malloc find
+// the smallest usable free block without walking the heap; when there is
+// none, the block is carved from the program break with sbrk().
+
+#define ALIGN (2 * sizeof(size_t))
+#define SMALL_CLASSES 64
+#define SMALL_MAX (SMALL_CLASSES * ALIGN)
+#define NBINS (SMALL_CLASSES + 8 * sizeof(size_t))
+#define MAP_WORDS ((NBINS + 31) / 32)
+
+#define INUSE 1
+
+struct block {
+  size_t prev_size; // header + payload of the previous block, 0 for the first
+  size_t size;      // payload size, INUSE in the lowest bit
+};
+
+// Free blocks keep their bin links in the payload.
+struct link {
+  struct block *next, *prev;
+};
+
+typedef struct block *Block;
+
+#define HDR sizeof(struct block)
+
+static intptr_t heap_base = 0;
+static Block top = NULL; // the block that ends at the program break
+static Block bins[NBINS];
+static uint32_t bin_map[MAP_WORDS];
+
+static inline size_t align(size_t size) {
+  return (size + (ALIGN - 1)) & ~(ALIGN - 1);
+}
+
+static inline size_t blk_size(Block b) { return b->size & ~(size_t)INUSE; }
+static inline int blk_inuse(Block b) { return b->size & INUSE; }
+static inline struct link *blk_link(Block b) { return (struct link *)(b + 1); }
+
+static inline Block blk_next(Block b) {
+  return b == top ? NULL : (Block)((char *)(b + 1) + blk_size(b));
+}
+
+static inline Block blk_prev(Block b) {
+  return b->prev_size ? (Block)((char *)b - b->prev_size) : NULL;
+}
+
+static void blk_set(Block b, size_t size, int inuse) {
+  b->size = size | inuse;
+  Block next = blk_next(b);
+  if (next) {
+    next->prev_size = HDR + size;
+  }
+}
+
+static int bin_index(size_t size) {
+  if (size <= SMALL_MAX)
+    return size / ALIGN - 1;
+  int i = SMALL_CLASSES;
+  for (size_t s = size / SMALL_MAX; s > 1; s >>= 1)
+    i++;
+  return i;
+}
+
+static void bin_insert(Block b) {
+  int i = bin_index(blk_size(b));
+  struct link *l = blk_link(b);
+  l->prev = NULL;
+  l->next = bins[i];
+  if (l->next) {
+    blk_link(l->next)->prev = b;
+  }
+  bins[i] = b;
+  bin_map[i / 32] |= 1u << (i % 32);
+}
+
+static void bin_remove(Block b) {
+  int i = bin_index(blk_size(b));
+  struct link *l = blk_link(b);
+  if (l->prev) {
+    blk_link(l->prev)->next = l->next;
+  } else {
+    bins[i] = l->next;
+  }
+  if (l->next) {
+    blk_link(l->next)->prev = l->prev;
+  }
+  if (!bins[i]) {
+    bin_map[i / 32] &= ~(1u << (i % 32));
+  }
+}
+
+// Returns the first non-empty bin at or above `i`, or -1.
+static int bin_next(int i) {
+  for (int w = i / 32; w < MAP_WORDS; w++) {
+    STAT(stats.walk_steps++);
+    uint32_t m = bin_map[w];
+    if (w == i / 32) {
+      m &= ~0u << (i % 32);
+    }
+    if (m) {
+      return w * 32 + __builtin_ctz(m);
+    }
+  }
+  return -1;
+}
+
+static Block bin_take(size_t size) {
+  int i = bin_index(size);
+  // Power-of-two bins hold a range of sizes, so only their head is not
+  // guaranteed to fit; every bin above `i` is.
+  if (i >= SMALL_CLASSES) {
+    for (Block b = bins[i]; b; b = blk_link(b)->next) {
+      STAT(stats.walk_steps++);
+      if (blk_size(b) >= size) {
+        bin_remove(b);
+        return b;
+      }
+    }
+    i++;
+  }
+  if ((i = bin_next(i)) < 0)
+    return NULL;
+  Block b = bins[i];
+  bin_remove(b);
+  return b;
+}
+
+static Block heap_extend(size_t size) {
+  Block b = sbrk(HDR + size);
+  if (b == (void *)-1)
+    return NULL;
+  b->prev_size = top ? HDR + blk_size(top) : 0;
+  top = b;
+  b->size = size | INUSE;
+  return b;
+}
+
+static void blk_release(Block b) {
+  size_t size = blk_size(b);
+  Block next = blk_next(b), prev = blk_prev(b);
+
+  if (next && !blk_inuse(next)) {
+    bin_remove(next);
+    if (next == top)
+      top = b;
+    size += HDR + blk_size(next);
+  }
+  if (prev && !blk_inuse(prev)) {
+    bin_remove(prev);
+    if (b == top)
+      top = prev;
+    size += HDR + blk_size(prev);
+    b = prev;
+  }
+  if (b == top) {
+    top = blk_prev(b);
+    sbrk(-(intptr_t)(HDR + size));
+    return;
+  }
+  blk_set(b, size, 0);
+  bin_insert(b);
+}
+
+// Shrinks the in-use block `b` to `size` bytes and frees the tail, if the
+// tail is large enough to hold a block of its own.
+static void blk_split(Block b, size_t size) {
+  size_t rest = blk_size(b) - size;
+  if (rest < HDR + ALIGN)
+    return;
+  Block r = (Block)((char *)(b + 1) + size);
+  r->prev_size = HDR + size;
+  b->size = size | INUSE;
+  if (b == top)
+    top = r;
+  blk_set(r, rest - HDR, INUSE);
+  blk_release(r);
+}
+
+static inline Block blk_of(void *ptr) {
+  if (!ptr || (intptr_t)ptr < heap_base + (intptr_t)HDR ||
+      (intptr_t)ptr >= program_break || ((intptr_t)ptr & (ALIGN - 1)))
+    return NULL;
+  Block b = (Block)ptr - 1;
+  return blk_inuse(b) ? b : NULL;
+}
+
+static void heap_init() {
+  program_break = heap_base = (intptr_t)align((size_t)heap.start);
+  top = NULL;
+  for (int i = 0; i < NBINS; i++)
+    bins[i] = NULL;
+  for (int i = 0; i < MAP_WORDS; i++)
+    bin_map[i] = 0;
+}
+
+static void *do_malloc(size_t size) {
+  // align() would wrap the largest sizes around to 0.
+  if (!size || size > SIZE_MAX - ALIGN)
+    return NULL;
+  size = align(size);
+  Block b = bin_take(size);
+  if (b) {
+    b->size |= INUSE;
+    blk_split(b, size);
+  } else if (!(b = heap_extend(size))) {
+    return NULL;
+  }
+  return b + 1;
+}
+
+static void do_free(void *ptr) {
+  Block b = blk_of(ptr);
+  if (b)
+    blk_release(b);
+}
+
+static void *do_realloc(void *ptr, size_t size) {
+  Block b = blk_of(ptr);
+  if (!b)
+    return do_malloc(size);
+  if (!size) {
+    blk_release(b);
+    return NULL;
+  }
+  if (size > SIZE_MAX - ALIGN)
+    return NULL;
+  size_t old_size = blk_size(b);
+  size = align(size);
+
+  // Grow in place: absorb a free successor, then move the program break if
+  // the block ends up at the top of the heap.
+  Block next = blk_next(b);
+  if (size > old_size && next && !blk_inuse(next)) {
+    bin_remove(next);
+    if (next == top)
+      top = b;
+    blk_set(b, old_size + HDR + blk_size(next), INUSE);
+  }
+  if (size > blk_size(b) && b == top) {
+    sbrk(size - blk_size(b));
+    b->size = size | INUSE;
+  }
+  if (size <= blk_size(b)) {
+    blk_split(b, size);
+    return ptr;
+  }
+
+  void *newptr = do_malloc(size);
+  if (newptr) {
+    bench_memcpy(newptr, ptr, old_size);
+    do_free(ptr);
+  }
+  return newptr;
+}
+
+#ifdef BENCH_MALLOC_STATS
+static size_t do_usable_size(void *ptr) {
+  Block b = blk_of(ptr);
+  return b ? blk_size(b) : 0;
+}
+#endif
+
+#endif
+
+#ifdef BENCH_MALLOC_STATS
+static void stat_enter() {
+  if (stats.depth++ == 0)
+    stats.start = uptime();
+}
+
+static void stat_leave() {
+  if (--stats.depth == 0)
+    stats.time_us += uptime() - stats.start;
+  if (program_break > stats.peak_break) {
+    stats.peak_break = program_break;
+    stats.live_at_peak = stats.live;
+  }
+}
+#endif
+
+// We need this function because the variable `heap` is used
+// and initialized at runtime.
+void bench_malloc_init() {
+  heap_init();
+  STAT(memset(&stats, 0, sizeof(stats)));
+  STAT(stats.peak_break = program_break);
+}
+
+void *bench_malloc(size_t size) {
+  STAT(stat_enter());
+  void *ptr = do_malloc(size);
+  STAT(stats.malloc_calls++);
+  STAT(stats.bytes_requested += size);
+  STAT(stats.live += do_usable_size(ptr));
+  STAT(stat_leave());
+  return ptr;
+}
+
+void bench_free(void *ptr) {
+  STAT(stat_enter());
+  STAT(stats.free_calls++);
+  STAT(stats.live -= do_usable_size(ptr));
+  do_free(ptr);
+  STAT(stat_leave());
+}
+
 void *bench_calloc(size_t nmemb, size_t size) {
+  STAT(stat_enter());
   size_t length = nmemb * size;
-  void *ptr = bench_malloc(length);
-  if (ptr) {
-    char *dst = ptr;
-    for (size_t i = 0; i < length; *dst = 0, ++dst, ++i)
-      ;
-  }
+  void *ptr = do_malloc(length);
+  if (ptr)
+    bench_memset(ptr, 0, length);
+  STAT(stats.calloc_calls++);
+  STAT(stats.bytes_requested += length);
+  STAT(stats.live += do_usable_size(ptr));
+  STAT(stat_leave());
   return ptr;
 }
 
 void *bench_realloc(void *ptr, size_t size) {
-  void *newptr = bench_malloc(size);
-  if (newptr && ptr && ptr >= malloc_base() && ptr <= sbrk(0)) {
-    Chunk c = (Chunk)ptr - 1;
-    if (c->data == ptr) {
-      size_t length = c->size > size ? size : c->size;
-      char *dst = newptr, *src = ptr;
-      for (size_t i = 0; i < length; *dst = *src, ++src, ++dst, ++i)
-        ;
-      bench_free(ptr);
-    }
-  }
+  STAT(stat_enter());
+  STAT(stats.realloc_calls++);
+  STAT(stats.bytes_requested += size);
+  STAT(stats.live -= do_usable_size(ptr));
+  void *newptr = do_realloc(ptr, size);
+  STAT(stats.live += do_usable_size(newptr));
+  STAT(stat_leave());
   return newptr;
 }
 
-void bench_all_free() { program_break = (intptr_t)heap.start; }
+void bench_all_free() {
+  heap_init();
+  STAT(stats.live = 0);
+}
+
+void bench_malloc_report() {
+#ifdef BENCH_MALLOC_STATS
+  uint64_t calls =
+      stats.malloc_calls + stats.calloc_calls + stats.realloc_calls;
+  size_t heap_size = (char *)heap.end - (char *)heap.start;
+  size_t peak = stats.peak_break - (intptr_t)heap.start;
+
+  BENCH_LOG(INFO,
+            "Malloc calls: malloc %llu, calloc %llu, realloc %llu, free %llu",
+            (unsigned long long)stats.malloc_calls,
+            (unsigned long long)stats.calloc_calls,
+            (unsigned long long)stats.realloc_calls,
+            (unsigned long long)stats.free_calls);
+  BENCH_LOG(INFO, "Malloc requested: %llu bytes, walk: %llu steps (%.2f/call)",
+            (unsigned long long)stats.bytes_requested,
+            (unsigned long long)stats.walk_steps,
+            calls ? (double)stats.walk_steps / calls : 0.0);
+  BENCH_LOG(INFO, "Malloc peak heap: %lu of %lu bytes, fragmentation: %.2f%%",
+            (unsigned long)peak, (unsigned long)heap_size,
+            peak ? 100.0 * (peak - stats.live_at_peak) / peak : 0.0);
+  BENCH_LOG(INFO, "Malloc time: %s", format_time(stats.time_us));
+#endif
+}
@@ -0,0 +1,88 @@
+#include <bench_mem.h>
+#include <stdint.h>
+
+// Keep GCC from turning the loops below back into calls to klib's memcpy and
+// memset, which are free to be byte-at-a-time.
+#if defined(__GNUC__) && !defined(__clang__)
+#define NO_LIBCALL __attribute__((optimize("no-tree-loop-distribute-patterns")))
+#else
+#define NO_LIBCALL
+#endif
+
+typedef unsigned long __attribute__((may_alias)) word_t;
+
+#define WSIZE sizeof(word_t)
+#define WMASK (WSIZE - 1)
+
+#ifdef BENCH_MEM_VLEN
+typedef word_t vec_t
+    __attribute__((vector_size(BENCH_MEM_VLEN), aligned(sizeof(word_t))));
+
+#define BLOCK BENCH_MEM_VLEN
+
+static inline void copy_block(word_t *d, const word_t *s) {
+  *(vec_t *)d = *(const vec_t *)s;
+}
+
+static inline void fill_block(word_t *d, word_t w) {
+  vec_t v = {0};
+  *(vec_t *)d = v + w;
+}
+#else
+#define BLOCK (4 * WSIZE)
+
+static inline void copy_block(word_t *d, const word_t *s) {
+  word_t w0 = s[0], w1 = s[1], w2 = s[2], w3 = s[3];
+  d[0] = w0;
+  d[1] = w1;
+  d[2] = w2;
+  d[3] = w3;
+}
+
+static inline void fill_block(word_t *d, word_t w) {
+  d[0] = w;
+  d[1] = w;
+  d[2] = w;
+  d[3] = w;
+}
+#endif
+
+NO_LIBCALL void *bench_memcpy(void *dst, const void *src, size_t n) {
+  unsigned char *d = dst;
+  const unsigned char *s = src;
+
+  // Word accesses need both pointers to share the same misalignment.
+  if (((uintptr_t)d ^ (uintptr_t)s) & WMASK) {
+    while (n--)
+      *d++ = *s++;
+    return dst;
+  }
+  for (; n && ((uintptr_t)d & WMASK); n--)
+    *d++ = *s++;
+  for (; n >= BLOCK; n -= BLOCK, d += BLOCK, s += BLOCK)
+    copy_block((word_t *)d, (const word_t *)s);
+  for (; n >= WSIZE; n -= WSIZE, d += WSIZE, s += WSIZE)
+    *(word_t *)d = *(const word_t *)s;
+  while (n--)
+    *d++ = *s++;
+  return dst;
+}
+
+NO_LIBCALL void *bench_memset(void *dst, int c, size_t n) {
+  unsigned char *d = dst;
+  word_t w = (unsigned char)c;
+  w |= w << 8;
+  w |= w << 16;
+  if (WSIZE > 4)
+    w |= w << 16 << 16;
+
+  for (; n && ((uintptr_t)d & WMASK); n--)
+    *d++ = (unsigned char)c;
+  for (; n >= BLOCK; n -= BLOCK, d += BLOCK)
+    fill_block((word_t *)d, w);
+  for (; n >= WSIZE; n -= WSIZE, d += WSIZE)
+    *(word_t *)d = w;
+  while (n--)
+    *d++ = (unsigned char)c;
+  return dst;
+}
@@ -0,0 +1,118 @@
+#include <am.h>
+#include <bench.h>
+#include <bench_debug.h>
+
+// Hardware counter backends for bench_perf_begin/end. The backend is chosen
+// with BENCH_PERF in the library Makefile; without one, native x86 builds use
+// rdtsc and every other target reports wall time only. A platform can also
+// provide its own non-weak bench_perf_read().
+
+#if defined(BENCH_PERF_RISCV)
+
+#if __riscv_xlen == 32
+#define READ_CSR64(csr)                                                        \
+  ({                                                                           \
+    uint32_t __hi, __lo, __hi2;                                                \
+    do {                                                                       \
+      asm volatile("csrr %0, " #csr "h" : "=r"(__hi));                         \
+      asm volatile("csrr %0, " #csr : "=r"(__lo));                             \
+      asm volatile("csrr %0, " #csr "h" : "=r"(__hi2));                        \
+    } while (__hi != __hi2);                                                   \
+    ((uint64_t)__hi << 32) | __lo;                                             \
+  })
+#else
+#define READ_CSR64(csr)                                                        \
+  ({                                                                           \
+    uint64_t __v;                                                              \
+    asm volatile("csrr %0, " #csr : "=r"(__v));                                \
+    __v;                                                                       \
+  })
+#endif
+
+__attribute__((weak)) int bench_perf_read(uint64_t *cycles,
+                                          uint64_t *instret) {
+  *cycles = READ_CSR64(mcycle);
+  *instret = READ_CSR64(minstret);
+  return BENCH_PERF_CYCLES | BENCH_PERF_INSTRET;
+}
+
+#elif defined(BENCH_PERF_PERF_EVENT)
+
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+static int perf_open(uint32_t config) {
+  struct perf_event_attr attr = {0};
+  attr.type = PERF_TYPE_HARDWARE;
+  attr.size = sizeof(attr);
+  attr.config = config;
+  attr.exclude_kernel = 1;
+  attr.exclude_hv = 1;
+  return syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+}
+
+__attribute__((weak)) int bench_perf_read(uint64_t *cycles,
+                                          uint64_t *instret) {
+  static int fd_cycles = -2, fd_instret = -2;
+  int valid = 0;
+  if (fd_cycles == -2) {
+    fd_cycles = perf_open(PERF_COUNT_HW_CPU_CYCLES);
+    fd_instret = perf_open(PERF_COUNT_HW_INSTRUCTIONS);
+    if (fd_cycles < 0 || fd_instret < 0)
+      BENCH_LOG(WARN, "perf_event_open failed, counters are not available");
+  }
+  if (fd_cycles >= 0 && read(fd_cycles, cycles, sizeof(*cycles)) > 0)
+    valid |= BENCH_PERF_CYCLES;
+  if (fd_instret >= 0 && read(fd_instret, instret, sizeof(*instret)) > 0)
+    valid |= BENCH_PERF_INSTRET;
+  return valid;
+}
+
+#elif !defined(BENCH_PERF_NONE) && (defined(__x86_64__) || defined(__i386__))
+
+__attribute__((weak)) int bench_perf_read(uint64_t *cycles,
+                                          uint64_t *instret) {
+  uint32_t lo, hi;
+  asm volatile("rdtsc" : "=a"(lo), "=d"(hi));
+  *cycles = ((uint64_t)hi << 32) | lo;
+  *instret = 0;
+  return BENCH_PERF_CYCLES;
+}
+
+#else
+
+__attribute__((weak)) int bench_perf_read(uint64_t *cycles,
+                                          uint64_t *instret) {
+  *cycles = *instret = 0;
+  return 0;
+}
+
+#endif
+
+void bench_perf_begin(bench_perf *p) {
+  p->valid = bench_perf_read(&p->cycles, &p->instret);
+  p->time = uptime();
+}
+
+void bench_perf_end(bench_perf *p) {
+  uint64_t time = uptime(), cycles, instret;
+  p->valid &= bench_perf_read(&cycles, &instret);
+  p->time = time - p->time;
+  p->cycles = cycles - p->cycles;
+  p->instret = instret - p->instret;
+}
+
+char *format_counters(bench_perf *p) {
+  static char buf[128];
+  int len = 0;
+  buf[0] = '\0';
+  if (p->valid & BENCH_PERF_CYCLES)
+    len += bench_sprintf(buf + len, ", cycles: %llu", p->cycles);
+  if (p->valid & BENCH_PERF_INSTRET)
+    len += bench_sprintf(buf + len, ", instret: %llu", p->instret);
+  if ((p->valid & BENCH_PERF_CYCLES) && (p->valid & BENCH_PERF_INSTRET) &&
+      p->cycles)
+    bench_sprintf(buf + len, ", IPC: %.3f", (double)p->instret / p->cycles);
+  return buf;
+}
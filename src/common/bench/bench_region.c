@@ -0,0 +1,114 @@
+#include <am.h>
+#include <bench.h>
+#include <bench_debug.h>
+#include <klib.h>
+
+// Named region timers. Regions are registered by name into a fixed table and
+// may nest: a region's inclusive time covers everything between start and
+// stop, its self time excludes the regions started inside it. A recursive
+// start of an already active region is only counted once.
+
+typedef struct {
+  const char *name;
+  uint64_t calls;
+  uint64_t self;
+  bench_perf total;
+  bench_perf cur;
+  int depth;
+} region_t;
+
+typedef struct {
+  int id;
+  uint64_t child;
+} frame_t;
+
+static region_t regions[BENCH_REGION_MAX];
+static int nregions;
+static frame_t stack[BENCH_REGION_MAX];
+static int sp;
+
+int bench_region(const char *name) {
+  for (int i = 0; i < nregions; i++) {
+    if (strcmp(regions[i].name, name) == 0)
+      return i;
+  }
+  if (nregions == BENCH_REGION_MAX) {
+    BENCH_LOG(WARN, "Region table full, \"%s\" is not timed", name);
+    return -1;
+  }
+  regions[nregions].name = name;
+  regions[nregions].total.valid = -1;
+  return nregions++;
+}
+
+void bench_region_start(int id) {
+  if (id < 0)
+    return;
+  region_t *r = &regions[id];
+  if (r->depth++ > 0)
+    return;
+  if (sp == BENCH_REGION_MAX) {
+    BENCH_LOG(ERROR, "Regions nested too deeply at \"%s\"", r->name);
+    halt(1);
+  }
+  stack[sp].id = id;
+  stack[sp].child = 0;
+  sp++;
+  bench_perf_begin(&r->cur);
+}
+
+void bench_region_stop(int id) {
+  if (id < 0)
+    return;
+  region_t *r = &regions[id];
+  if (r->depth == 0) {
+    BENCH_LOG(WARN, "Region \"%s\" stopped without start", r->name);
+    return;
+  }
+  if (--r->depth > 0)
+    return;
+  bench_perf_end(&r->cur);
+  int top = sp - 1;
+  while (top >= 0 && stack[top].id != id)
+    top--;
+  if (top < 0) {
+    BENCH_LOG(WARN, "Region \"%s\" was unwound by an outer stop", r->name);
+    return;
+  }
+  if (top != sp - 1) {
+    BENCH_LOG(WARN, "Region \"%s\" stopped inside \"%s\"", r->name,
+              regions[stack[sp - 1].id].name);
+  }
+  // Regions still open above this one are dropped, so they cannot be charged
+  // to a parent that has already stopped.
+  sp = top;
+  r->calls++;
+  r->self += r->cur.time - stack[sp].child;
+  r->total.time += r->cur.time;
+  r->total.cycles += r->cur.cycles;
+  r->total.instret += r->cur.instret;
+  r->total.valid &= r->cur.valid;
+  if (sp > 0)
+    stack[sp - 1].child += r->cur.time;
+}
+
+void bench_region_report(void) {
+  for (int i = 0; i < nregions; i++) {
+    region_t *r = &regions[i];
+    if (r->calls == 0)
+      r->total.valid = 0;
+    BENCH_LOG(INFO, "Region %s: calls: %llu, total: %llu us, self: %llu us%s",
+              r->name, r->calls, r->total.time, r->self,
+              format_counters(&r->total));
+  }
+}
+
+// Region timers as fields of the result record, see bench_result().
+void bench_region_fields(void) {
+  for (int i = 0; i < nregions; i++) {
+    region_t *r = &regions[i];
+    bench_printf(" region.%s.calls=%llu region.%s.time_us=%llu"
+                 " region.%s.self_us=%llu",
+                 r->name, r->calls, r->name, r->total.time, r->name, r->self);
+  }
+}
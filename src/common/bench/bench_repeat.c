@@ -0,0 +1,103 @@
+#include <am.h>
+#include <bench.h>
+#include <bench_debug.h>
+#include <klib.h>
+
+// Repetition driver. The measured region runs warmup_time times untimed and
+// then repeat_time times timed (both from bench_setting, overridden by the
+// BENCH_WARMUP/BENCH_REPEAT build options). The benchmark reports the median
+// run; min and stddev go to the log and the result record.
+
+static bench_perf runs[BENCH_REPEAT_MAX];
+static int nruns;
+static uint64_t min_time, stddev_time;
+
+static size_t repeat_count(void) {
+#ifdef BENCH_REPEAT
+  size_t n = BENCH_REPEAT;
+#else
+  size_t n = bench_setting.repeat_time;
+#endif
+  if (n == 0)
+    n = 1;
+  if (n > BENCH_REPEAT_MAX) {
+    BENCH_LOG(WARN, "Repeat count %d exceeds %d, using %d", (int)n,
+              BENCH_REPEAT_MAX, BENCH_REPEAT_MAX);
+    n = BENCH_REPEAT_MAX;
+  }
+  return n;
+}
+
+static size_t warmup_count(void) {
+#ifdef BENCH_WARMUP
+  return BENCH_WARMUP;
+#else
+  return bench_setting.warmup_time;
+#endif
+}
+
+static uint64_t isqrt(uint64_t x) {
+  uint64_t r = 0;
+  for (uint64_t bit = 1ull << 62; bit; bit >>= 2) {
+    if (x >= r + bit) {
+      x -= r + bit;
+      r = (r >> 1) + bit;
+    } else {
+      r >>= 1;
+    }
+  }
+  return r;
+}
+
+void bench_repeat(void (*setup)(void *), void (*run)(void *), void *arg,
+                  bench_perf *perf) {
+  size_t warmup = warmup_count();
+  for (size_t i = 0; i < warmup; i++) {
+    if (setup)
+      setup(arg);
+    run(arg);
+  }
+
+  nruns = repeat_count();
+  for (int i = 0; i < nruns; i++) {
+    if (setup)
+      setup(arg);
+    bench_perf_begin(&runs[i]);
+    run(arg);
+    bench_perf_end(&runs[i]);
+  }
+
+  // Insertion sort by time, there are only a few runs.
+  for (int i = 1; i < nruns; i++) {
+    bench_perf r = runs[i];
+    int j = i - 1;
+    for (; j >= 0 && runs[j].time > r.time; j--)
+      runs[j + 1] = runs[j];
+    runs[j + 1] = r;
+  }
+
+  uint64_t total = 0;
+  for (int i = 0; i < nruns; i++)
+    total += runs[i].time;
+  uint64_t mean = total / nruns;
+  uint64_t var = 0;
+  for (int i = 0; i < nruns; i++) {
+    int64_t d = runs[i].time - mean;
+    var += d * d;
+  }
+  min_time = runs[0].time;
+  stddev_time = isqrt(var / nruns);
+  *perf = runs[nruns / 2];
+
+  if (nruns > 1)
+    BENCH_LOG(INFO, "Runs: %d (+%d warm-up), min %llu us, median %llu us, "
+              "stddev %llu us", nruns, (int)warmup, min_time, perf->time,
+              stddev_time);
+}
+
+void bench_repeat_fields(void) {
+  if (nruns <= 1)
+    return;
+  bench_printf(" runs=%d time_min_us=%llu time_stddev_us=%llu", nruns,
+               min_time, stddev_time);
+}
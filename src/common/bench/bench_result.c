@@ -0,0 +1,81 @@
+#include <am.h>
+#include <bench.h>
+#include <bench_debug.h>
+
+// One machine-readable record per benchmark run, collected by the top-level
+// Makefile into JSON/CSV. The line holds space-separated key=value fields
+// after a fixed prefix; values never contain spaces.
+
+__attribute__((weak)) Setting bench_setting;
+
+static uint64_t result_ops;
+
+static struct {
+  char key[BENCH_FIELD_KEY];
+  double value;
+} fields[BENCH_FIELD_MAX];
+static int nfields;
+
+void bench_result_ops(uint64_t ops) { result_ops = ops; }
+
+void bench_result_field(double value, const char *fmt, ...) {
+  if (nfields == BENCH_FIELD_MAX) {
+    BENCH_LOG(WARN, "Too many result fields, dropping %s", fmt);
+    return;
+  }
+  char key[256];
+  va_list ap;
+  va_start(ap, fmt);
+  bench_vsprintf(key, fmt, ap);
+  va_end(ap);
+  int i = 0;
+  for (; key[i] && i < BENCH_FIELD_KEY - 1; i++)
+    fields[nfields].key[i] = key[i];
+  fields[nfields].key[i] = '\0';
+  fields[nfields++].value = value;
+}
+
+void bench_result(const char *name, uint64_t size, uint32_t sum,
+                  bench_perf *perf) {
+  bench_printf("OpenPerf result: bench=%s time_us=%llu size=%llu", name,
+               perf->time, size);
+  if (sum)
+    bench_printf(" checksum=0x%08x", sum);
+  if (bench_setting.checksum)
+    bench_printf(" expected=0x%08x", bench_setting.checksum);
+  if (bench_setting.ref_time)
+    bench_printf(" ref_time_us=%llu", bench_setting.ref_time);
+  if (perf->valid & BENCH_PERF_CYCLES)
+    bench_printf(" cycles=%llu", perf->cycles);
+  if (perf->valid & BENCH_PERF_INSTRET)
+    bench_printf(" instret=%llu", perf->instret);
+  if (result_ops) {
+    bench_printf(" ops=%llu", result_ops);
+    if (perf->time)
+      bench_printf(" mops=%.2f", (double)result_ops / perf->time);
+  }
+  for (int i = 0; i < nfields; i++) {
+    double v = fields[i].value;
+    if (v >= 0 && v == (uint64_t)v)
+      bench_printf(" %s=%llu", fields[i].key, (uint64_t)v);
+    else
+      bench_printf(" %s=%.3f", fields[i].key, v);
+  }
+  bench_repeat_fields();
+  bench_region_fields();
+  bench_printf("\n");
+}
+
+int bench_verify(uint32_t sum) {
+  if (bench_setting.checksum == 0) {
+    BENCH_LOG(WARN, "Checksum: 0x%08x, no expected value for this input", sum);
+    return 0;
+  }
+  if (sum != bench_setting.checksum) {
+    BENCH_LOG(ERROR, "Checksum: 0x%08x, expected 0x%08x", sum,
+              bench_setting.checksum);
+    return 1;
+  }
+  BENCH_LOG(INFO, "Checksum: 0x%08x, OK", sum);
+  return 0;
+}
@@ -14,14 +14,105 @@ uint32_t checksum(void *start, void *end);
 void bench_srand(uint32_t _seed);
 uint32_t bench_rand();
 
+#define BENCH_PERF_CYCLES 1
+#define BENCH_PERF_INSTRET 2
+
+// A measured region: wall time in us plus the hardware counters that the
+// selected backend can read (see `valid`).
+typedef struct {
+  uint64_t time;
+  uint64_t cycles;
+  uint64_t instret;
+  int valid;
+} bench_perf;
+
+int bench_perf_read(uint64_t *cycles, uint64_t *instret);
+void bench_perf_begin(bench_perf *p);
+void bench_perf_end(bench_perf *p);
+char *format_counters(bench_perf *p);
+
+// Print the "OpenPerf result:" record of a run. `size` is a benchmark-specific
+// measure of the input, `sum` the output checksum (0 if there is none).
+void bench_result(const char *name, uint64_t size, uint32_t sum,
+                  bench_perf *perf);
+// Operations (FLOPs, or the benchmark's own unit) of the reported run. When
+// set, the record gets `ops` and the rate `mops` in millions per second.
+void bench_result_ops(uint64_t ops);
+
+#define BENCH_FIELD_MAX 32
+#define BENCH_FIELD_KEY 48
+
+// Add a benchmark-specific field to the record, named by the printf-style
+// `fmt` (e.g. "module.%s.time_us"). Whole values print as integers.
+void bench_result_field(double value, const char *fmt, ...);
+// Compare the output checksum `sum` with bench_setting.checksum. Returns
+// nonzero on a mismatch, which the benchmark passes on as its exit code.
+int bench_verify(uint32_t sum);
+
+#define BENCH_REPEAT_MAX 64
+
+// Run the measured region `run(arg)` through the repetition driver, see
+// bench_repeat.c. `setup(arg)`, if given, runs untimed before every run and
+// must bring the state back to the same input. `perf` gets the median run.
+void bench_repeat(void (*setup)(void *), void (*run)(void *), void *arg,
+                  bench_perf *perf);
+void bench_repeat_fields(void);
+
+#define BENCH_REGION_MAX 16
+
+// Named region timers, see bench_region.c. bench_region() returns the id of
+// `name`, registering it on first use, or -1 if the table is full.
+int bench_region(const char *name);
+void bench_region_start(int id);
+void bench_region_stop(int id);
+void bench_region_report(void);
+void bench_region_fields(void);
+
+// Instrumentation points in the benchmarks. They compile to nothing unless
+// the benchmark is built with BENCH_REGIONS=1, and look up the region id only
+// once per call site.
+#ifdef BENCH_REGIONS
+#define BENCH_REGION_START(name)                                               \
+  do {                                                                         \
+    static int __region = -2;                                                  \
+    if (__region == -2)                                                        \
+      __region = bench_region(name);                                           \
+    bench_region_start(__region);                                              \
+  } while (0)
+#define BENCH_REGION_STOP(name)                                                \
+  do {                                                                         \
+    static int __region = -2;                                                  \
+    if (__region == -2)                                                        \
+      __region = bench_region(name);                                           \
+    bench_region_stop(__region);                                               \
+  } while (0)
+#else
+#define BENCH_REGION_START(name)                                               \
+  do {                                                                         \
+  } while (0)
+#define BENCH_REGION_STOP(name)                                                \
+  do {                                                                         \
+  } while (0)
+#endif
+
 typedef struct {
   void *sub_config;
   size_t mlim;
   uint64_t ref_time;
   uint32_t checksum;
   size_t repeat_time;
+  size_t warmup_time;
 } Setting;
 
+// Per-input settings of the running benchmark, defined next to its config in
+// configs/<input>-config.c. A benchmark without one gets an all-zero default.
+// ref_time is the run time in us on the reference platform, used by `make run`
+// to compute the benchmark's ratio; 0 leaves it to REF_RESULT. checksum is the
+// expected output checksum, 0 if it is not known for this input. repeat_time
+// and warmup_time are the timed and untimed runs of bench_repeat(); 0 means a
+// single cold run.
+extern Setting bench_setting;
+
 #ifdef  __cplusplus
 }
 #endif
@@ -14,6 +14,8 @@ void *bench_calloc(size_t number, size_t size);
 void *bench_realloc(void *p, size_t size);
 void bench_free(void *ptr);
 void bench_all_free(void);
+// Prints allocator statistics when built with BENCH_MALLOC_STATS=1.
+void bench_malloc_report(void);
 
 #ifdef  __cplusplus
 }
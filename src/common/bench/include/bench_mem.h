@@ -0,0 +1,20 @@
+#ifndef __BENCH_MEM_H
+#define __BENCH_MEM_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+
+// Word-at-a-time memcpy/memset. The bulk of the buffer is moved in blocks of
+// four machine words, or of BENCH_MEM_VLEN bytes through GCC vector types
+// when the library is built with BENCH_MEM_VLEN set.
+void *bench_memcpy(void *dst, const void *src, size_t n);
+void *bench_memset(void *dst, int c, size_t n);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
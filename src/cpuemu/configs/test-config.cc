@@ -1,4 +1,7 @@
+#include <bench.h>
 #include <cpuemu.h>
 
 
 bench_cpuemu_config config = { 0 };
+
+Setting bench_setting = {.sub_config = &config, .ref_time = 7943};
@@ -18,8 +18,8 @@ int main(const char *args) {
 
   int pass = 1;
 
-  uint64_t start_time, end_time;
-  start_time = uptime();
+  bench_perf perf;
+  bench_perf_begin(&perf);
   switch (config.setting_id) {
   case 0:
     rvmini();
@@ -31,8 +31,11 @@ int main(const char *args) {
     nutshell();
     break;
   }
-  end_time = uptime();
+  bench_perf_end(&perf);
 
-  BENCH_LOG(INFO, "OpenPerf time: %s", format_time(end_time - start_time));
+  BENCH_LOG(INFO, "OpenPerf time: %s%s", format_time(perf.time),
+            format_counters(&perf));
+  bench_malloc_report();
+  bench_result("cpuemu", config.setting_id, 0, &perf);
   return (pass ? 0 : 1);
 }
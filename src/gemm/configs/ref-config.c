@@ -1,4 +1,11 @@
 #include <gemm.h>
 
-bench_gemm_config config = {.m = 110, .n = 110, .k = 110, .checksum = 0x503d0fe9};
+bench_gemm_config config = {.m = 110, .n = 110, .k = 110,
+                             .mc = 64, .kc = 128, .nc = 256};
 
+Setting bench_setting = {
+    .sub_config = &config,
+    .checksum = GEMM_CHECKSUM(0x4fc3ffbd, 0x92898d29),
+    .ref_time = 357,
+    .repeat_time = 3,
+    .warmup_time = 1};
@@ -1,3 +1,11 @@
 #include <gemm.h>
 
-bench_gemm_config config = {.m = 50, .n = 50, .k = 50, .checksum = 0x53c1fb28};
+bench_gemm_config config = {.m = 50, .n = 50, .k = 50,
+                             .mc = 64, .kc = 128, .nc = 256};
+
+Setting bench_setting = {
+    .sub_config = &config,
+    .checksum = GEMM_CHECKSUM(0x3af91e81, 0xd3603c44),
+    .ref_time = 35,
+    .repeat_time = 5,
+    .warmup_time = 1};
@@ -1,3 +1,11 @@
 #include <gemm.h>
 
-bench_gemm_config config = {.m = 40, .n = 40, .k = 40, .checksum = 0x1efebe93};
+bench_gemm_config config = {.m = 40, .n = 40, .k = 40,
+                             .mc = 64, .kc = 128, .nc = 256};
+
+Setting bench_setting = {
+    .sub_config = &config,
+    .checksum = GEMM_CHECKSUM(0x444fd86e, 0xaa51b7e2),
+    .ref_time = 26,
+    .repeat_time = 5,
+    .warmup_time = 1};
@@ -4,7 +4,7 @@
 
 #define A(i, j) a[(j) * lda + (i)]
 
-void serial_init(int m, int n, double *a, int lda) {
+void serial_init(int m, int n, gemm_t *a, int lda) {
   int count = 1;
   for (int j = 0; j < n; j++) {
     for (int i = 0; i < m; i++)
@@ -12,15 +12,97 @@ void serial_init(int m, int n, double *a, int lda) {
   }
 }
 
-void random_init(int m, int n, double *a, int lda) {
+void random_init(int m, int n, gemm_t *a, int lda) {
   for (int j = 0; j < n; j++) {
     for (int i = 0; i < m; i++)
-      A(i, j) = 2.0 * bench_rand() - 1.0;
+      A(i, j) = GEMM_RAND();
   }
 }
 
 extern bench_gemm_config config;
 
+static gemm_t *A, *B;
+static gemm_acc_t *C;
+
+// matmul accumulates into C, so every run starts from a zero C.
+static void gemm_setup(void *arg) {
+  bench_memset(C, 0, config.m * config.n * sizeof(gemm_acc_t));
+}
+
+static void gemm_run(void *arg) {
+  matmul(config.m, config.n, config.k, A, config.m, B, config.k, C, config.m);
+}
+
+// Checks sampled entries of C, always including the corners, against naive
+// dot products in double. Blocking changes where the partial sums are
+// rounded, so a floating-point entry may differ from the reference by up to k
+// ulps of the sum of the magnitudes of its terms. Integer entries are exact.
+static int gemm_check(void) {
+  int m = config.m, n = config.n, k = config.k;
+  int bad = 0;
+
+  for (int s = 0; s < GEMM_SAMPLES; s++) {
+    int i = s == 0 ? 0 : s == 1 ? m - 1 : bench_rand() % m;
+    int j = s == 0 ? 0 : s == 1 ? n - 1 : bench_rand() % n;
+    double ref = 0.0, mag = 0.0;
+    for (int p = 0; p < k; p++) {
+      double t = (double)A[p * m + i] * B[j * k + p];
+      ref += t;
+      mag += t < 0 ? -t : t;
+    }
+    double err = C[j * m + i] - ref;
+    if ((err < 0 ? -err : err) > k * GEMM_EPS * mag) {
+      BENCH_LOG(ERROR, "C(%d, %d) = %f, expected %f", i, j,
+                (double)C[j * m + i], ref);
+      bad++;
+    }
+  }
+
+  if (bad) {
+    BENCH_LOG(ERROR, "Verification: %d of %d sampled entries of C are wrong",
+              bad, GEMM_SAMPLES);
+    return 1;
+  }
+  BENCH_LOG(INFO, "Verification: %d sampled entries of C match, OK",
+            GEMM_SAMPLES);
+  return 0;
+}
+
+#ifdef GEMM_KERNELS
+// Runs the product again with every micro-kernel and prints the best of three
+// runs of each, which shows the register tile the core sustains best. The
+// checksum column compares C with the measured run. Not part of the measured
+// time.
+static void gemm_kernels_report(uint32_t sum) {
+  double ops = 2.0 * config.m * config.n * config.k;
+
+  printf("Kernel  Tile  Best(us)  G%s/s  %s/cycle  Checksum\n", GEMM_OP,
+         GEMM_OP);
+  for (int i = 0; i < gemm_nkernels; i++) {
+    const gemm_kernel *kern = &gemm_kernels[i];
+    bench_perf perf, best = {.time = UINT64_MAX};
+    for (int r = 0; r < 3; r++) {
+      gemm_setup(NULL);
+      bench_perf_begin(&perf);
+      matmul_kernel(kern, config.m, config.n, config.k, A, config.m, B,
+                    config.k, C, config.m);
+      bench_perf_end(&perf);
+      if (perf.time < best.time)
+        best = perf;
+    }
+    uint32_t ksum = checksum(C, C + config.m * config.n);
+
+    printf("%-6s  %dx%d  %8llu  %8.3f", kern->name, kern->mr, kern->nr,
+           best.time, best.time ? ops / best.time / 1000 : 0.0);
+    if (best.valid & BENCH_PERF_CYCLES)
+      printf("  %10.3f", ops / best.cycles);
+    else
+      printf("  %10s", "-");
+    printf("  %s\n", ksum == sum ? "same" : "differs");
+  }
+}
+#endif
+
 int main() {
 
   bench_malloc_init();
@@ -29,34 +111,46 @@ int main() {
   int k = config.k;
 
   // TODO: calculate the memory size.
-  double *A = (double *)bench_malloc(m * k * sizeof(double));
-  double *B = (double *)bench_malloc(k * n * sizeof(double));
-  double *C = (double *)bench_malloc(m * n * sizeof(double));
+  A = (gemm_t *)bench_malloc(m * k * sizeof(gemm_t));
+  B = (gemm_t *)bench_malloc(k * n * sizeof(gemm_t));
+  C = (gemm_acc_t *)bench_malloc(m * n * sizeof(gemm_acc_t));
   assert(A);
   assert(B);
   assert(C);
 
-  memset(A, 0, m * k * sizeof(double));
-  memset(B, 0, k * n * sizeof(double));
-  memset(C, 0, m * n * sizeof(double));
+  bench_memset(A, 0, m * k * sizeof(gemm_t));
+  bench_memset(B, 0, k * n * sizeof(gemm_t));
 
-  uint64_t start_time, end_time;
+  bench_perf perf;
   bench_srand(1556);
 
   //Because we init A and B randomly, the checksum of C will be different.
   random_init(m, k, A, m);
   random_init(k, n, B, k);
 
-  start_time = uptime();
-  matmul(m, n, k, A, m, B, k, C, m);
-  end_time = uptime();
+  bench_repeat(gemm_setup, gemm_run, NULL, &perf);
 
+  uint32_t sum = checksum(C, C + m * n);
+  int bad = gemm_check();
+#ifdef GEMM_KERNELS
+  gemm_kernels_report(sum);
+#endif
 
   bench_free(A);
   bench_free(B);
   bench_free(C);
 
 
-  BENCH_LOG(INFO, "OpenPerf time: %s", format_time(end_time - start_time));
-  return 0;
+  // 2mnk operations per run, one multiply and one add per term.
+  uint64_t ops = 2ull * m * n * k;
+  BENCH_LOG(INFO, "OpenPerf time: %s%s", format_time(perf.time),
+            format_counters(&perf));
+  if (perf.time)
+    BENCH_LOG(INFO, "G" GEMM_OP "/s: %.3f", (double)ops / perf.time / 1000);
+  if (perf.valid & BENCH_PERF_CYCLES)
+    BENCH_LOG(INFO, GEMM_OP "/cycle: %.3f", (double)ops / perf.cycles);
+  bench_malloc_report();
+  bench_result_ops(ops);
+  bench_result(GEMM_NAME, (uint64_t)m * n * k, sum, &perf);
+  return bench_verify(sum) | bad;
 }
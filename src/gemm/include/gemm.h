@@ -1,22 +1,101 @@
 #include <am.h>
 #include <bench.h>
 #include <bench_malloc.h>
+#include <bench_mem.h>
 #include <klib-macros.h>
 #include <klib.h>
 #include <stdint.h>
 
 #define TEST
+
+// Element type, GEMM_TYPE at build time: A and B hold gemm_t, and C
+// accumulates their products in gemm_acc_t. GEMM_EPS is the machine epsilon
+// of gemm_acc_t, 0 for exact integer arithmetic. GEMM_RAND() draws an input
+// element.
+#if defined(GEMM_F32)
+typedef float gemm_t;
+typedef float gemm_acc_t;
+#define GEMM_NAME "gemm-f32"
+#define GEMM_OP "FLOP"
+#define GEMM_EPS 0x1p-23
+#define GEMM_RAND() (bench_rand() / 16384.0f - 1.0f)
+#elif defined(GEMM_I8)
+typedef int8_t gemm_t;
+typedef int32_t gemm_acc_t;
+#define GEMM_NAME "gemm-i8"
+#define GEMM_OP "OP"
+#define GEMM_EPS 0
+#define GEMM_RAND() (bench_rand() % 256 - 128)
+#else
+typedef double gemm_t;
+typedef double gemm_acc_t;
+#define GEMM_NAME "gemm"
+#define GEMM_OP "FLOP"
+#define GEMM_EPS 0x1p-52
+#define GEMM_RAND() (2.0 * bench_rand() - 1.0)
+#endif
+
+// Expected checksum of an input for the element type of the build. The f64
+// inputs are integers, so C is exact whatever the order of the sums and the
+// use of fused multiply-adds. The f32 products round, so f32 has no expected
+// hash and C is verified by gemm_check() alone.
+#if defined(GEMM_F32)
+#define GEMM_CHECKSUM(f64, i8) 0
+#elif defined(GEMM_I8)
+#define GEMM_CHECKSUM(f64, i8) (i8)
+#else
+#define GEMM_CHECKSUM(f64, i8) (f64)
+#endif
+
+// Largest register tile of a micro-kernel, in elements.
+#define GEMM_TILE_MAX 256
+
+#ifdef GEMM_VLEN
+// Accumulators per vector of the vector micro-kernel.
+#define GEMM_VL (GEMM_VLEN / sizeof(gemm_acc_t))
+#endif
+
+// Default cache blocking: a kc x nr panel of B should stay in L1 and the
+// packed mc x kc block of A in L2 (or L1 on cores without one).
+#define GEMM_MC 64
+#define GEMM_KC 128
+#define GEMM_NC 256
+
+// Entries of C checked against a naive product.
+#define GEMM_SAMPLES 64
+
 typedef struct {
   uint32_t m;
   uint32_t n;
   uint32_t k;
-  uint64_t checksum;
+  // Block sizes of matmul(), 0 for the defaults above.
+  uint32_t mc;
+  uint32_t kc;
+  uint32_t nc;
 } bench_gemm_config;
 
-void AddDot4x4(int, double *, int, double *, int, double *, int);
-void PackMatrixA(int, double *, int, double *);
-void PackMatrixB(int, double *, int, double *);
-void InnerKernel(int, int, int, double *, int, double *, int, double *, int,
-                 int);
-void matmul(int m, int n, int k, double *a, int lda, double *b, int ldb,
-            double *c, int ldc);
+// A micro-kernel and the mr x nr register tile it computes.
+typedef struct {
+  const char *name;
+  int mr;
+  int nr;
+  void (*fn)(int, gemm_t *, gemm_t *, gemm_acc_t *, int);
+} gemm_kernel;
+
+extern const gemm_kernel gemm_kernels[];
+extern const int gemm_nkernels;
+const gemm_kernel *gemm_default_kernel(void);
+
+void AddDot4x4(int, gemm_t *, gemm_t *, gemm_acc_t *, int);
+void AddDot8x4(int, gemm_t *, gemm_t *, gemm_acc_t *, int);
+void AddDot4x8(int, gemm_t *, gemm_t *, gemm_acc_t *, int);
+void AddDot8x8(int, gemm_t *, gemm_t *, gemm_acc_t *, int);
+void AddDotVec(int, gemm_t *, gemm_t *, gemm_acc_t *, int);
+void PackMatrixA(int, int, int, gemm_t *, int, gemm_t *);
+void PackMatrixB(int, int, int, gemm_t *, int, gemm_t *);
+void InnerKernel(const gemm_kernel *, int, int, int, gemm_t *, gemm_t *,
+                 gemm_acc_t *, int);
+void matmul(int m, int n, int k, gemm_t *a, int lda, gemm_t *b, int ldb,
+            gemm_acc_t *c, int ldc);
+void matmul_kernel(const gemm_kernel *kern, int m, int n, int k, gemm_t *a,
+                   int lda, gemm_t *b, int ldb, gemm_acc_t *c, int ldc);
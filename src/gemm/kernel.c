@@ -0,0 +1,88 @@
+#include <gemm.h>
+
+// Micro-kernels: C(0:mr, 0:nr) += the product of a packed mr x k panel of A
+// and a packed k x nr panel of B, accumulated in gemm_acc_t. The accumulators
+// are a local array that GCC unrolls and keeps in registers, so one macro
+// generates every tile shape. Each element of C is summed in the same order
+// whatever the shape.
+
+#define C(i, j) c[(j) * ldc + (i)]
+
+#define GEMM_MICRO_KERNEL(MR, NR)                                              \
+  void AddDot##MR##x##NR(int k, gemm_t *a, gemm_t *b, gemm_acc_t *c,          \
+                          int ldc) {                                           \
+    gemm_acc_t acc[MR][NR];                                                    \
+    _Pragma("GCC unroll 16") for (int i = 0; i < MR; i++)                      \
+      _Pragma("GCC unroll 16") for (int j = 0; j < NR; j++) acc[i][j] = 0;     \
+                                                                               \
+    for (int p = 0; p < k; p++) {                                              \
+      _Pragma("GCC unroll 16") for (int j = 0; j < NR; j++)                    \
+        _Pragma("GCC unroll 16") for (int i = 0; i < MR; i++)                  \
+          acc[i][j] += (gemm_acc_t)a[i] * b[j];                                \
+      a += MR;                                                                 \
+      b += NR;                                                                 \
+    }                                                                          \
+                                                                               \
+    _Pragma("GCC unroll 16") for (int j = 0; j < NR; j++)                      \
+      _Pragma("GCC unroll 16") for (int i = 0; i < MR; i++)                    \
+        C(i, j) += acc[i][j];                                                  \
+  }
+
+GEMM_MICRO_KERNEL(4, 4)
+GEMM_MICRO_KERNEL(8, 4)
+GEMM_MICRO_KERNEL(4, 8)
+GEMM_MICRO_KERNEL(8, 8)
+
+#ifdef GEMM_VLEN
+// Two vectors of rows times four columns through GCC vector types. Rows of A
+// are loaded as GEMM_VL elements and widened to the accumulator type. The
+// columns of C need not be aligned.
+typedef gemm_acc_t vacc_t
+    __attribute__((vector_size(GEMM_VLEN), aligned(sizeof(gemm_acc_t))));
+typedef gemm_t vin_t __attribute__((vector_size(GEMM_VL * sizeof(gemm_t)),
+                                    aligned(sizeof(gemm_t))));
+
+void AddDotVec(int k, gemm_t *a, gemm_t *b, gemm_acc_t *c, int ldc) {
+  vacc_t acc[2][4] = {0};
+
+  for (int p = 0; p < k; p++) {
+    vacc_t a0 = __builtin_convertvector(*(vin_t *)a, vacc_t);
+    vacc_t a1 = __builtin_convertvector(*(vin_t *)(a + GEMM_VL), vacc_t);
+    _Pragma("GCC unroll 4") for (int j = 0; j < 4; j++) {
+      acc[0][j] += a0 * (gemm_acc_t)b[j];
+      acc[1][j] += a1 * (gemm_acc_t)b[j];
+    }
+    a += 2 * GEMM_VL;
+    b += 4;
+  }
+
+  _Pragma("GCC unroll 4") for (int j = 0; j < 4; j++) {
+    *(vacc_t *)&C(0, j) += acc[0][j];
+    *(vacc_t *)&C(GEMM_VL, j) += acc[1][j];
+  }
+}
+#endif
+
+const gemm_kernel gemm_kernels[] = {
+    {"4x4", 4, 4, AddDot4x4},
+    {"8x4", 8, 4, AddDot8x4},
+    {"4x8", 4, 8, AddDot4x8},
+    {"8x8", 8, 8, AddDot8x8},
+#ifdef GEMM_VLEN
+    {"vec", 2 * GEMM_VL, 4, AddDotVec},
+#endif
+};
+const int gemm_nkernels = LENGTH(gemm_kernels);
+
+#ifndef GEMM_KERNEL
+#define GEMM_KERNEL AddDot4x4
+#endif
+
+const gemm_kernel *gemm_default_kernel(void) {
+  for (int i = 0; i < gemm_nkernels; i++) {
+    if (gemm_kernels[i].fn == GEMM_KERNEL)
+      return &gemm_kernels[i];
+  }
+  assert(0);
+  return NULL;
+}
@@ -3,102 +3,81 @@
 #define A(i, j) a[(j) * lda + (i)]
 #define B(i, j) b[(j) * ldb + (i)]
 #define C(i, j) c[(j) * ldc + (i)]
-
-void AddDot4x4(int k, double *a, int lda, double *b, int ldb, double *c,
-               int ldc) {
-
-  register double c_00, c_01, c_02, c_03, c_10, c_11, c_12, c_13, c_20, c_21,
-      c_22, c_23, c_30, c_31, c_32, c_33, a_0p, a_1p, a_2p, a_3p, b_0p_reg,
-      b_1p_reg, b_2p_reg, b_3p_reg;
-  double *b_0p_ptr, *b_1p_ptr, *b_2p_ptr, *b_3p_ptr;
-
-  c_00 = 0.0;
-  c_01 = 0.0;
-  c_02 = 0.0;
-  c_03 = 0.0;
-  c_10 = 0.0;
-  c_11 = 0.0;
-  c_12 = 0.0;
-  c_13 = 0.0;
-  c_20 = 0.0;
-  c_21 = 0.0;
-  c_22 = 0.0;
-  c_23 = 0.0;
-  c_30 = 0.0;
-  c_31 = 0.0;
-  c_32 = 0.0;
-  c_33 = 0.0;
-
-  b_0p_ptr = &B(0, 0);
-  b_1p_ptr = &B(0, 1);
-  b_2p_ptr = &B(0, 2);
-  b_3p_ptr = &B(0, 3);
-
-  // #pragma omp parallel for num_threads(4)
-  for (int p = 0; p < k; p++) {
-    a_0p = A(0, p);
-    a_1p = A(1, p);
-    a_2p = A(2, p);
-    a_3p = A(3, p);
-
-    b_0p_reg = *b_0p_ptr++;
-    b_1p_reg = *b_1p_ptr++;
-    b_2p_reg = *b_2p_ptr++;
-    b_3p_reg = *b_3p_ptr++;
-
-    c_00 += a_0p * b_0p_reg;
-    c_10 += a_1p * b_0p_reg;
-
-    c_01 += a_0p * b_1p_reg;
-    c_11 += a_1p * b_1p_reg;
-
-    c_02 += a_0p * b_2p_reg;
-    c_12 += a_1p * b_2p_reg;
-
-    c_03 += a_0p * b_3p_reg;
-    c_13 += a_1p * b_3p_reg;
-
-    c_20 += a_2p * b_0p_reg;
-    c_30 += a_3p * b_0p_reg;
-
-    c_21 += a_2p * b_1p_reg;
-    c_31 += a_3p * b_1p_reg;
-
-    c_22 += a_2p * b_2p_reg;
-    c_32 += a_3p * b_2p_reg;
-
-    c_23 += a_2p * b_3p_reg;
-    c_33 += a_3p * b_3p_reg;
+#define MIN(x, y) ((x) < (y) ? (x) : (y))
+
+extern bench_gemm_config config;
+
+// Blocked GEMM in the style of Goto's algorithm: C is computed in nc-wide
+// column blocks, k in kc-deep slices. B's kc x nc block is packed once per
+// slice, A's mc x kc block once per row block, and the micro-kernel walks the
+// packed panels with unit stride. Partial panels at the edges are padded with
+// zeros, so the micro-kernel always computes a full tile.
+
+// Packs the mc x kc block of A into panels of mr rows, each stored as kc
+// groups of mr consecutive elements.
+void PackMatrixA(int mr, int mc, int kc, gemm_t *a, int lda,
+                 gemm_t *packed) {
+  for (int i = 0; i < mc; i += mr) {
+    for (int p = 0; p < kc; p++) {
+      for (int r = 0; r < mr; r++)
+        *packed++ = i + r < mc ? A(i + r, p) : 0;
+    }
   }
+}
 
-  C(0, 0) += c_00;
-  C(0, 1) += c_01;
-  C(0, 2) += c_02;
-  C(0, 3) += c_03;
-
-  C(1, 0) += c_10;
-  C(1, 1) += c_11;
-  C(1, 2) += c_12;
-  C(1, 3) += c_13;
+// Packs the kc x nc block of B into panels of nr columns, each stored as kc
+// groups of nr consecutive elements.
+void PackMatrixB(int nr, int kc, int nc, gemm_t *b, int ldb,
+                 gemm_t *packed) {
+  for (int j = 0; j < nc; j += nr) {
+    for (int p = 0; p < kc; p++) {
+      for (int r = 0; r < nr; r++)
+        *packed++ = j + r < nc ? B(p, j + r) : 0;
+    }
+  }
+}
 
-  C(2, 0) += c_20;
-  C(2, 1) += c_21;
-  C(2, 2) += c_22;
-  C(2, 3) += c_23;
+// C(0:mc, 0:nc) += packed A block * packed B block, one micro-kernel call per
+// mr x nr tile. Edge tiles go through a scratch tile.
+void InnerKernel(const gemm_kernel *kern, int mc, int nc, int kc,
+                 gemm_t *packedA, gemm_t *packedB, gemm_acc_t *c, int ldc) {
+  int mr = kern->mr, nr = kern->nr;
+  gemm_acc_t tile[GEMM_TILE_MAX];
+  assert(mr * nr <= GEMM_TILE_MAX);
+
+  for (int j = 0; j < nc; j += nr) {
+    for (int i = 0; i < mc; i += mr) {
+      gemm_t *a = &packedA[i * kc];
+      gemm_t *b = &packedB[j * kc];
+      if (i + mr <= mc && j + nr <= nc) {
+        kern->fn(kc, a, b, &C(i, j), ldc);
+        continue;
+      }
+      for (int t = 0; t < mr * nr; t++)
+        tile[t] = 0;
+      kern->fn(kc, a, b, tile, mr);
+      for (int jj = j; jj < nc && jj < j + nr; jj++) {
+        for (int ii = i; ii < mc && ii < i + mr; ii++)
+          C(ii, jj) += tile[(jj - j) * mr + (ii - i)];
+      }
+    }
+  }
+}
 
-  C(3, 0) += c_30;
-  C(3, 1) += c_31;
-  C(3, 2) += c_32;
-  C(3, 3) += c_33;
+// matmul() with the micro-kernel chosen at build time.
+void matmul(int m, int n, int k, gemm_t *a, int lda, gemm_t *b, int ldb,
+            gemm_acc_t *c, int ldc) {
+  matmul_kernel(gemm_default_kernel(), m, n, k, a, lda, b, ldb, c, ldc);
 }
 
-void matmul(int m, int n, int k, double *a, int lda, double *b, int ldb,
-            double *c, int ldc) {
+void matmul_kernel(const gemm_kernel *kern, int m, int n, int k, gemm_t *a,
+                   int lda, gemm_t *b, int ldb, gemm_acc_t *c, int ldc) {
   /*
   Computes the matrix multiplication of A and B and stores in C.
   C = A*B + C
   Arguments
   ---------
+          kern : micro-kernel computing the register tiles
           m,n,k : Specifies matrix dimensions
           a : pointer to first matrix
           b : pointer to second matrix
@@ -117,11 +96,30 @@ void matmul(int m, int n, int k, double *a, int lda, double *b, int ldb,
         "Argument Error : One of the input arguments to matmul() was NULL\n");
     return;
   }
-  // #pragma omp parallel for num_threads(4)
-  for (int j = 0; j < n; j += 4) {   // Loop over the columns of C with stride 4
-    for (int i = 0; i < m; i += 4) { // Loop over the rows of C
-      AddDot4x4(k, &A(i, 0), lda, &B(0, j), ldb, &C(i, j), ldc);
+  int mc = config.mc ? config.mc : GEMM_MC;
+  int kc = config.kc ? config.kc : GEMM_KC;
+  int nc = config.nc ? config.nc : GEMM_NC;
+  mc = ROUNDUP(mc, kern->mr);
+  nc = ROUNDUP(nc, kern->nr);
+
+  gemm_t *packedA = bench_malloc(mc * kc * sizeof(gemm_t));
+  gemm_t *packedB = bench_malloc(kc * nc * sizeof(gemm_t));
+  assert(packedA);
+  assert(packedB);
+
+  for (int jc = 0; jc < n; jc += nc) {
+    int nb = MIN(n - jc, nc);
+    for (int pc = 0; pc < k; pc += kc) {
+      int kb = MIN(k - pc, kc);
+      PackMatrixB(kern->nr, kb, nb, &B(pc, jc), ldb, packedB);
+      for (int ic = 0; ic < m; ic += mc) {
+        int mb = MIN(m - ic, mc);
+        PackMatrixA(kern->mr, mb, kb, &A(ic, pc), lda, packedA);
+        InnerKernel(kern, mb, nb, kb, packedA, packedB, &C(ic, jc), ldc);
+      }
     }
   }
-  return;
+
+  bench_free(packedA);
+  bench_free(packedB);
 }
@@ -1,3 +1,11 @@
+#include <bench.h>
 #include <linpack.h>
 
-bench_linpack_config config = {270};
+bench_linpack_config config = {.arsize = 270, .block = 32};
+
+Setting bench_setting = {
+    .sub_config = &config,
+    .checksum = 0x63063511,
+    .ref_time = LINPACK_REF_TIME(2179, 2128),
+    .repeat_time = 3,
+    .warmup_time = 1};
@@ -1,3 +1,11 @@
+#include <bench.h>
 #include <linpack.h>
 
-bench_linpack_config config = {100};
+bench_linpack_config config = {.arsize = 100, .block = 16};
+
+Setting bench_setting = {
+    .sub_config = &config,
+    .checksum = 0xbedc4972,
+    .ref_time = LINPACK_REF_TIME(133, 135),
+    .repeat_time = 5,
+    .warmup_time = 1};
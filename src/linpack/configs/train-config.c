@@ -1,3 +1,11 @@
+#include <bench.h>
 #include <linpack.h>
 
-bench_linpack_config config = {80};
+bench_linpack_config config = {.arsize = 80, .block = 16};
+
+Setting bench_setting = {
+    .sub_config = &config,
+    .checksum = 0xca99c87a,
+    .ref_time = LINPACK_REF_TIME(69, 70),
+    .repeat_time = 5,
+    .warmup_time = 1};
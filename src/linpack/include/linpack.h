@@ -4,11 +4,12 @@
 #define FLT_DIG 6
 #define DBL_DIG 15
 
-#define SP
-
-#ifndef SP
+/* Single precision unless built with -DDP, as the linpack-dp target is.
+ * Both share the configs, which give LINPACK_REF_TIME() the reference time
+ * of each precision. */
 #ifndef DP
-#define DP
+#ifndef SP
+#define SP
 #endif
 #endif
 
@@ -17,6 +18,9 @@
 #define ONE 1.0
 #define PREC "Single"
 #define BASE10DIG FLT_DIG
+#define EPS 0x1p-23
+#define LINPACK_NAME "linpack"
+#define LINPACK_REF_TIME(sp, dp) (sp)
 
 typedef float REAL;
 #endif
@@ -26,6 +30,9 @@ typedef float REAL;
 #define ONE 1.0e0
 #define PREC "Double"
 #define BASE10DIG DBL_DIG
+#define EPS 0x1p-52
+#define LINPACK_NAME "linpack-dp"
+#define LINPACK_REF_TIME(sp, dp) (dp)
 
 typedef double REAL;
 #endif
@@ -35,8 +42,18 @@ typedef double REAL;
  */
 #define MEM_T long
 
+/* LU variants, see residual() */
+#define LU_ROLLED 0
+#define LU_UNROLLED 1
+#define LU_BLOCKED 2
+
+/* Largest normalized residual of a correct solve */
+#define RESID_MAX 16
+
 typedef struct {
   int arsize;
+  /* Panel width of the blocked LU pass, 0 to leave it out */
+  int block;
 } bench_linpack_config;
 
 #endif
@@ -38,11 +38,21 @@
 
 extern bench_linpack_config config;
 
-static REAL linpack(long nreps, int arsize);
+static void linpack_gen(void *arg);
+static void linpack(void *arg);
 static void matgen(REAL *a, int lda, int n, REAL *b, REAL *norma);
 static void dgefa(REAL *a, int lda, int n, int *ipvt, int *info, int roll);
 static void dgesl(REAL *a, int lda, int n, int *ipvt, REAL *b, int job,
                   int roll);
+static void dgetrf(REAL *a, int lda, int n, int *ipvt, int *info, int nb);
+static void dgetrs(REAL *a, int lda, int n, int *ipvt, REAL *b);
+static void dlaswp(REAL *a, int lda, int c0, int c1, int k0, int k1,
+                   int *ipvt);
+static void dgemm_nn(int m, int n, int k, REAL *a, int lda, REAL *b, int ldb,
+                     REAL *c, int ldc);
+static REAL residual(int lda, int n, int lu);
+static double pass_ops(int lu, int n);
+static int report(int lu, int arsize);
 static void daxpy_r(int n, REAL da, REAL *dx, int incx, REAL *dy, int incy);
 static REAL ddot_r(int n, REAL *dx, int incx, REAL *dy, int incy);
 static void dscal_r(int n, REAL da, REAL *dx, int incx);
@@ -50,26 +60,36 @@ static void daxpy_ur(int n, REAL da, REAL *dx, int incx, REAL *dy, int incy);
 static REAL ddot_ur(int n, REAL *dx, int incx, REAL *dy, int incy);
 static void dscal_ur(int n, REAL da, REAL *dx, int incx);
 static int idamax(int n, REAL *dx, int incx);
-static REAL second(void);
 static inline double fabs(double x) { return x < 0 ? -x : x; }
 
+/*
+** mempool holds the system of every LU_* pass, a (lda x lda) followed by b
+** (lda), and then the pivots, shared by all passes.
+*/
 static void *mempool = NULL;
+static inline REAL *pass_a(int lu, int lda) {
+  return (REAL *)mempool + lu * ((long)lda * lda + lda);
+}
+static inline int *pivots(int lda) {
+  return (int *)pass_a(LU_BLOCKED + 1, lda);
+}
+static bench_perf pass_perf[3]; /* the fastest solve of each LU_* pass */
 int main(int argc, char **argv)
 
 {
   // ioe_init();
   bench_malloc_init();
   int arsize;
-  long arsize2d, nreps;
+  long arsize2d;
   volatile size_t malloc_arg;
   volatile MEM_T memreq;
 
   arsize = config.arsize;
   arsize2d = (long)arsize * (long)arsize;
-  memreq = arsize2d * sizeof(REAL) + (long)arsize * sizeof(REAL) +
+  memreq = 3 * (arsize2d * sizeof(REAL) + (long)arsize * sizeof(REAL)) +
            (long)arsize * sizeof(int);
   malloc_arg = (size_t)memreq;
-  uint64_t start_time, end_time;
+  bench_perf perf;
 
   if ((MEM_T)malloc_arg != memreq ||
       (mempool = bench_malloc(malloc_arg)) == NULL) {
@@ -77,44 +97,89 @@ int main(int argc, char **argv)
     return 1;
   }
 
-  nreps = 1;
-  start_time = uptime();
-  while (linpack(nreps, arsize) < 10.) {
-    nreps *= 2;
+  /* a fixed number of repetitions, see bench_repeat.c */
+  for (int lu = LU_ROLLED; lu <= LU_BLOCKED; lu++)
+    pass_perf[lu].time = UINT64_MAX;
+  bench_repeat(linpack_gen, linpack, &arsize, &perf);
+  /*
+  ** The pivots of the last factorization. They are integers, so they do not
+  ** depend on the rounding of a core (e.g. on contracted multiply-adds), and
+  ** the residuals check the solution itself within a tolerance.
+  */
+  int *ipvt = pivots(arsize);
+  uint32_t sum = checksum(ipvt, ipvt + arsize / 2);
+
+  BENCH_LOG(INFO, "%s precision, n = %d", PREC, arsize / 2);
+  int bad = 0;
+  double ops = 0;
+  for (int lu = LU_ROLLED; lu <= LU_BLOCKED; lu++) {
+    if (lu == LU_BLOCKED && config.block <= 0)
+      continue;
+    bad |= report(lu, arsize);
+    ops += pass_ops(lu, arsize / 2);
   }
-  end_time = uptime();
+
   bench_free(mempool);
-  BENCH_LOG(INFO, "OpenPerf time: %s", format_time(end_time - start_time));
-  return 0;
+  BENCH_LOG(INFO, "OpenPerf time: %s%s", format_time(perf.time),
+            format_counters(&perf));
+  bench_malloc_report();
+  bench_result_ops(ops);
+  bench_result(LINPACK_NAME, arsize, sum, &perf);
+  return bench_verify(sum) | bad;
+}
+
+/*
+** Untimed before every repetition: generates the system of every pass, so the
+** matrix generation is not part of the time, as in the original benchmark.
+*/
+static void linpack_gen(void *arg)
+
+{
+  REAL norma;
+  int arsize = *(int *)arg;
+
+  for (int lu = LU_ROLLED; lu <= LU_BLOCKED; lu++) {
+    if (lu == LU_BLOCKED && config.block <= 0)
+      continue;
+    REAL *a = pass_a(lu, arsize);
+    matgen(a, arsize, arsize / 2, a + (long)arsize * arsize, &norma);
+  }
 }
 
-REAL linpack(long nreps, int arsize)
+/*
+** One repetition: a solve with every LU variant, each timed on its own.
+** The unrolled pass runs last, so its pivots are the ones checksummed.
+*/
+static void linpack(void *arg)
 
 {
+  static const int order[] = {LU_BLOCKED, LU_ROLLED, LU_UNROLLED};
   REAL *a, *b;
-  REAL norma, totalt;
-  int *ipvt, n, info, lda;
-  long i, arsize2d;
+  int *ipvt, n, info, lda, arsize, i, lu;
+  bench_perf p;
 
+  arsize = *(int *)arg;
   lda = arsize;
   n = arsize / 2;
-  arsize2d = (long)arsize * (long)arsize;
-  a = (REAL *)mempool;
-  b = a + arsize2d;
-  ipvt = (int *)&b[arsize];
-  totalt = second();
-  for (i = 0; i < nreps; i++) {
-    matgen(a, lda, n, b, &norma);
-    dgefa(a, lda, n, ipvt, &info, 1);
-    dgesl(a, lda, n, ipvt, b, 0, 1);
-  }
-  for (i = 0; i < nreps; i++) {
-    matgen(a, lda, n, b, &norma);
-    dgefa(a, lda, n, ipvt, &info, 0);
-    dgesl(a, lda, n, ipvt, b, 0, 0);
+  ipvt = pivots(arsize);
+  for (i = 0; i < 3; i++) {
+    lu = order[i];
+    if (lu == LU_BLOCKED && config.block <= 0)
+      continue;
+    a = pass_a(lu, lda);
+    b = a + (long)lda * lda;
+    bench_perf_begin(&p);
+    if (lu == LU_BLOCKED) {
+      dgetrf(a, lda, n, ipvt, &info, config.block);
+      dgetrs(a, lda, n, ipvt, b);
+    } else {
+      dgefa(a, lda, n, ipvt, &info, lu == LU_ROLLED);
+      dgesl(a, lda, n, ipvt, b, 0, lu == LU_ROLLED);
+    }
+    bench_perf_end(&p);
+    if (p.time < pass_perf[lu].time)
+      pass_perf[lu] = p;
   }
-  totalt = second() - totalt;
-  return (totalt);
 }
 
 /*
@@ -471,6 +536,250 @@ static void dgesl(REAL *a, int lda, int n, int *ipvt, REAL *b, int job,
   }
 }
 
+/*
+** Blocked right-looking LU factorization with partial pivoting, in the
+** manner of LAPACK's dgetrf. Each panel of nb columns is factored column by
+** column; its row interchanges are then applied to the columns on both sides,
+** the block row of U to its right is solved with the panel's unit lower
+** triangle, and the trailing matrix gets a rank-nb update through dgemm_nn.
+**
+** The result differs from dgefa's in the storage of the multipliers: like
+** LAPACK, interchanges are applied to whole rows, so the multipliers of
+** earlier columns move with them. Solve with dgetrs, not dgesl. The
+** multipliers are stored negated, as in dgefa.
+*/
+static void dgetrf(REAL *a, int lda, int n, int *ipvt, int *info, int nb)
+
+{
+  REAL t;
+  int i, j, jb, k, l, c;
+
+  *info = 0;
+  for (j = 0; j < n; j += nb) {
+    jb = n - j < nb ? n - j : nb;
+
+    /* factor the panel, columns j..j+jb-1 */
+
+    for (k = j; k < j + jb; k++) {
+      l = idamax(n - k, &a[lda * k + k], 1) + k;
+      ipvt[k] = l;
+      if (a[lda * k + l] == ZERO) {
+        *info = k;
+        continue;
+      }
+      dlaswp(a, lda, j, j + jb, k, k + 1, ipvt);
+      t = -ONE / a[lda * k + k];
+      dscal_ur(n - (k + 1), t, &a[lda * k + k + 1], 1);
+      for (c = k + 1; c < j + jb; c++)
+        daxpy_ur(n - (k + 1), a[lda * c + k], &a[lda * k + k + 1], 1,
+                 &a[lda * c + k + 1], 1);
+    }
+
+    /* apply the panel's interchanges to the columns left and right of it */
+
+    dlaswp(a, lda, 0, j, j, j + jb, ipvt);
+    dlaswp(a, lda, j + jb, n, j, j + jb, ipvt);
+
+    if (j + jb >= n)
+      break;
+
+    /* U12 = L11^-1 A12 */
+
+    for (c = j + jb; c < n; c++)
+      for (k = j; k < j + jb - 1; k++)
+        daxpy_ur(j + jb - (k + 1), a[lda * c + k], &a[lda * k + k + 1], 1,
+                 &a[lda * c + k + 1], 1);
+
+    /* A22 += L21 U12, the multipliers being negated */
+
+    i = j + jb;
+    dgemm_nn(n - i, n - i, jb, &a[lda * j + i], lda, &a[lda * i + j], lda,
+             &a[lda * i + i], lda);
+  }
+}
+
+/*
+** Interchanges rows k and ipvt[k] for k = k0..k1-1, in that order, in
+** columns c0..c1-1.
+*/
+static void dlaswp(REAL *a, int lda, int c0, int c1, int k0, int k1,
+                   int *ipvt)
+
+{
+  REAL t;
+  int c, k, l;
+
+  for (k = k0; k < k1; k++) {
+    l = ipvt[k];
+    if (l == k)
+      continue;
+    for (c = c0; c < c1; c++) {
+      t = a[lda * c + l];
+      a[lda * c + l] = a[lda * c + k];
+      a[lda * c + k] = t;
+    }
+  }
+}
+
+/*
+** Solves a * x = b with the factors from dgetrf: the interchanges are applied
+** to b first, then the unit lower and the upper triangular systems are solved.
+*/
+static void dgetrs(REAL *a, int lda, int n, int *ipvt, REAL *b)
+
+{
+  REAL t;
+  int k, l;
+
+  for (k = 0; k < n; k++) {
+    l = ipvt[k];
+    if (l != k) {
+      t = b[l];
+      b[l] = b[k];
+      b[k] = t;
+    }
+  }
+  for (k = 0; k < n - 1; k++)
+    daxpy_ur(n - (k + 1), b[k], &a[lda * k + k + 1], 1, &b[k + 1], 1);
+  for (k = n - 1; k >= 0; k--) {
+    b[k] = b[k] / a[lda * k + k];
+    daxpy_ur(k, -b[k], &a[lda * k + 0], 1, &b[0], 1);
+  }
+}
+
+/*
+** c += a * b for column-major a (m x k), b (k x n) and c (m x n). Two
+** columns and four rows of c are kept in registers over the whole k loop,
+** so c is loaded and stored once and every element of a is used twice.
+*/
+static void dgemm_nn(int m, int n, int k, REAL *a, int lda, REAL *b, int ldb,
+                     REAL *c, int ldc)
+
+{
+  int i, j, p;
+
+  for (j = 0; j + 1 < n; j += 2) {
+    REAL *b0 = &b[ldb * j], *b1 = &b[ldb * (j + 1)];
+    REAL *c0 = &c[ldc * j], *c1 = &c[ldc * (j + 1)];
+    for (i = 0; i + 3 < m; i += 4) {
+      REAL c00 = c0[i], c10 = c0[i + 1], c20 = c0[i + 2], c30 = c0[i + 3];
+      REAL c01 = c1[i], c11 = c1[i + 1], c21 = c1[i + 2], c31 = c1[i + 3];
+      for (p = 0; p < k; p++) {
+        REAL *ap = &a[lda * p + i];
+        REAL bp0 = b0[p], bp1 = b1[p];
+        c00 += ap[0] * bp0;
+        c10 += ap[1] * bp0;
+        c20 += ap[2] * bp0;
+        c30 += ap[3] * bp0;
+        c01 += ap[0] * bp1;
+        c11 += ap[1] * bp1;
+        c21 += ap[2] * bp1;
+        c31 += ap[3] * bp1;
+      }
+      c0[i] = c00;
+      c0[i + 1] = c10;
+      c0[i + 2] = c20;
+      c0[i + 3] = c30;
+      c1[i] = c01;
+      c1[i + 1] = c11;
+      c1[i + 2] = c21;
+      c1[i + 3] = c31;
+    }
+    for (; i < m; i++)
+      for (p = 0; p < k; p++) {
+        c0[i] += a[lda * p + i] * b0[p];
+        c1[i] += a[lda * p + i] * b1[p];
+      }
+  }
+  for (; j < n; j++)
+    for (p = 0; p < k; p++)
+      daxpy_ur(m, b[ldb * j + p], &a[lda * p], 1, &c[ldc * j], 1);
+}
+
+/*
+** Solves the benchmark's system once with the given LU variant, outside the
+** timed region, and returns the normalized residual of the original
+** benchmark, max|b - a*x| / (n * norma * normx * eps). A correct solve gives
+** a value of order 1.
+*/
+static REAL residual(int lda, int n, int lu)
+
+{
+  REAL *a, *b, *x, norma, normx, resid;
+  int *ipvt, info, i, j;
+
+  a = pass_a(lu, lda);
+  b = a + (long)lda * lda;
+  ipvt = pivots(lda);
+  x = bench_malloc(n * sizeof(REAL));
+  assert(x);
+
+  matgen(a, lda, n, b, &norma);
+  if (lu == LU_BLOCKED) {
+    dgetrf(a, lda, n, ipvt, &info, config.block);
+    dgetrs(a, lda, n, ipvt, b);
+  } else {
+    dgefa(a, lda, n, ipvt, &info, lu == LU_ROLLED);
+    dgesl(a, lda, n, ipvt, b, 0, lu == LU_ROLLED);
+  }
+  for (i = 0; i < n; i++)
+    x[i] = b[i];
+
+  /* b - a*x with a and b generated again */
+
+  matgen(a, lda, n, b, &norma);
+  for (j = 0; j < n; j++)
+    daxpy_r(n, -x[j], &a[lda * j], 1, b, 1);
+  resid = ZERO;
+  normx = ZERO;
+  for (i = 0; i < n; i++) {
+    resid = fabs(b[i]) > resid ? fabs(b[i]) : resid;
+    normx = fabs(x[i]) > normx ? fabs(x[i]) : normx;
+  }
+  bench_free(x);
+  return resid / (n * norma * normx * EPS);
+}
+
+/*
+** Floating-point operations of one solve of order n: the original
+** benchmark's 2/3 n^3 + 2 n^2 for the rolled and unrolled passes, HPL's
+** 2/3 n^3 + 3/2 n^2 for the blocked one.
+*/
+static double pass_ops(int lu, int n)
+
+{
+  double dn = n;
+  return 2.0 / 3.0 * dn * dn * dn + (lu == LU_BLOCKED ? 1.5 : 2.0) * dn * dn;
+}
+
+/*
+** Logs the MFLOPS of a pass's fastest solve and the normalized residual of
+** its solver. Returns nonzero if the residual shows a wrong solution.
+*/
+static int report(int lu, int arsize)
+
+{
+  static const char *names[] = {"Rolled", "Unrolled", "Blocked"};
+  double ops = pass_ops(lu, arsize / 2);
+  REAL resid = residual(arsize, arsize / 2, lu);
+
+  if (lu == LU_BLOCKED)
+    BENCH_LOG(INFO, "%s (nb %d): %.2f MFLOPS, norm. resid %.2f", names[lu],
+              config.block,
+              pass_perf[lu].time ? ops / pass_perf[lu].time : 0.0,
+              (double)resid);
+  else
+    BENCH_LOG(INFO, "%s: %.2f MFLOPS, norm. resid %.2f", names[lu],
+              pass_perf[lu].time ? ops / pass_perf[lu].time : 0.0,
+              (double)resid);
+  if (!(resid < RESID_MAX)) {
+    BENCH_LOG(ERROR, "%s: norm. resid %.2f exceeds %d", names[lu],
+              (double)resid, RESID_MAX);
+    return 1;
+  }
+  return 0;
+}
+
 /*
 ** Constant times a vector plus a vector.
 ** Jack Dongarra, linpack, 3/11/78.
@@ -762,9 +1071,3 @@ static int idamax(int n, REAL *dx, int incx)
   }
   return (itemp);
 }
-
-static REAL second(void)
-
-{
-  return ((REAL)(uptime() / 1000));
-}
@@ -0,0 +1,7 @@
+#include <bench.h>
+#include "input.h"
+
+// A graph generated by test-gen (MCF_NODES=<n>); the graph itself is read by
+// input_init(). Its checksum depends on the generator's arguments, so there
+// is no expected value.
+Setting bench_setting = {.repeat_time = 1};
@@ -1,16 +1,13 @@
+#include <bench.h>
 #include "input.h"
 
-const int nodes_num = 14;
-const int edges_num = 25;
-const int demands_num = 1;
-
-node_t node_buf[] = {
+static node_t nodes[] = {
     {0, 0, 0, 6},  {1, 0, 0, 1},  {2, 0, 0, 1},  {3, 0, 0, 1},  {4, 0, 0, 6},
     {5, 0, 0, 1},  {6, 0, 0, 1},  {7, 0, 0, 1},  {8, 0, 0, 2},  {9, 0, 0, 1},
     {10, 0, 0, 1}, {11, 0, 0, 2}, {12, 0, 0, 1}, {13, 0, 0, 1},
 };
 
-edge_t edge_buf[] = {
+static edge_t edges[] = {
     {0, 0, 1, 101, 122},    {1, 1, 2, 179, 377},    {2, 2, 3, 124, 202},
     {3, 3, 4, 125, 261},    {4, 4, 5, 182, 423},    {5, 5, 6, 184, 405},
     {6, 6, 7, 140, 259},    {7, 7, 8, 118, 398},    {8, 8, 9, 128, 228},
@@ -22,7 +19,7 @@ edge_t edge_buf[] = {
     {24, 11, 12, 179, 235},
 };
 
-demands_t demands_buf[] = {
+static demands_t demands[] = {
     {0, 0, 13, 10},  {1, 0, 1, 96},   {2, 1, 6, 78},   {3, 1, 9, 95},
     {4, 3, 5, 35},   {5, 3, 10, 77},  {6, 3, 13, 38},  {7, 3, 9, 98},
     {8, 3, 11, 92},  {9, 3, 6, 29},   {10, 3, 4, 38},  {11, 4, 10, 73},
@@ -34,3 +31,13 @@ demands_t demands_buf[] = {
     {32, 7, 12, 68}, {33, 7, 8, 33},  {34, 7, 10, 11}, {35, 8, 13, 82},
     {36, 8, 10, 7},  {37, 9, 10, 25}, {38, 9, 11, 84}, {39, 10, 13, 78},
 };
+
+int nodes_num = 14;
+int edges_num = 25;
+int demands_num = 1;
+node_t *node_buf = nodes;
+edge_t *edge_buf = edges;
+demands_t *demands_buf = demands;
+
+Setting bench_setting = {.checksum = 0xbd5460a6, .ref_time = 469,
+                         .repeat_time = 3, .warmup_time = 1};
@@ -1,25 +1,32 @@
+#include <bench.h>
 #include "input.h"
 
-const int nodes_num = 4;
-const int edges_num = 3;
-const int demands_num = 4;
-
-node_t node_buf[] = {
+static node_t nodes[] = {
     {0, 0, 0, 1},
     {1, 0, 0, 1},
     {2, 0, 0, 1},
     {3, 0, 0, 1},
 };
 
-edge_t edge_buf[] = {
+static edge_t edges[] = {
     {0, 0, 1, 121, 468},
     {1, 1, 2, 185, 328},
     {2, 2, 3, 141, 271},
 };
 
-demands_t demands_buf[] = {
+static demands_t demands[] = {
     {0, 0, 3, 10},
     {1, 0, 3, 60},
     {2, 0, 1, 92},
     {3, 1, 2, 18},
 };
+
+int nodes_num = 4;
+int edges_num = 3;
+int demands_num = 4;
+node_t *node_buf = nodes;
+edge_t *edge_buf = edges;
+demands_t *demands_buf = demands;
+
+Setting bench_setting = {.checksum = 0x5534d19a, .ref_time = 167,
+                         .repeat_time = 5, .warmup_time = 1};
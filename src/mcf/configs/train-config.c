@@ -1,20 +1,27 @@
+#include <bench.h>
 #include "input.h"
 
-const int nodes_num = 6;
-const int edges_num = 5;
-const int demands_num = 6;
-
-node_t node_buf[] = {
+static node_t nodes[] = {
     {0, 0, 0, 1}, {1, 0, 0, 1}, {2, 0, 0, 1},
     {3, 0, 0, 1}, {4, 0, 0, 1}, {5, 0, 0, 1},
 };
 
-edge_t edge_buf[] = {
+static edge_t edges[] = {
     {0, 0, 1, 164, 484}, {1, 1, 2, 193, 186}, {2, 2, 3, 167, 274},
     {3, 3, 4, 180, 133}, {4, 4, 5, 129, 348},
 };
 
-demands_t demands_buf[] = {
+static demands_t demands[] = {
     {0, 0, 5, 10}, {1, 0, 2, 52}, {2, 0, 4, 13},
     {3, 1, 5, 20}, {4, 1, 2, 72}, {5, 1, 3, 44},
 };
+
+int nodes_num = 6;
+int edges_num = 5;
+int demands_num = 6;
+node_t *node_buf = nodes;
+edge_t *edge_buf = edges;
+demands_t *demands_buf = demands;
+
+Setting bench_setting = {.checksum = 0x611d4f09, .ref_time = 438,
+                         .repeat_time = 5, .warmup_time = 1};
@@ -1,10 +1,6 @@
 #ifndef __TEST_H__
 #define __TEST_H__
 
-extern const int nodes_num;
-extern const int edges_num;
-extern const int demands_num;
-
 typedef struct {
   int id; // node id
   int x,
@@ -27,8 +23,15 @@ typedef struct {
   double amount;
 } demands_t;
 
-extern node_t node_buf[];
-extern edge_t edge_buf[];
-extern demands_t demands_buf[];
+// The input graph: defined by configs/<input>-config.c for the built-in
+// inputs, or by input_init() from the blob of a generated graph (MCF_NODES).
+extern int nodes_num;
+extern int edges_num;
+extern int demands_num;
+extern node_t *node_buf;
+extern edge_t *edge_buf;
+extern demands_t *demands_buf;
+
+void input_init(void);
 
 #endif
@@ -139,6 +139,19 @@ typedef struct {
   // arguments;
   PROBLEM_TYPE _problem_type;
   char _network_filename[512];
+
+#ifdef MCF_CSR
+  // compressed sparse row copy of the adjacency, built once by
+  // read_network_topology_and_demands() and streamed by Dijkstra: the edges
+  // leaving node v take positions adj_start[v] .. adj_start[v + 1] - 1, in
+  // the order of nodes[v].edges; adj_pos[e] is the position of edge e;
+  // the length function of the edges lives only in adj_length;
+  int *adj_start;
+  int *adj_pos;
+  int *adj_edge;
+  int *adj_dest;
+  double *adj_length;
+#endif
 } MCF;
 
 void MCF_init(MCF *mcf);
@@ -149,6 +162,14 @@ static inline double flow_of_commodity_thru_edge(MCF *mcf, int c_id, int e_id) {
   // assert(e_id >= 0 && e_id < no_edge);
   return flow_of_commodity(&mcf->edges[e_id], c_id);
 }
+// the "length function" l(e) of edge e_id;
+static inline double *length_of_edge(MCF *mcf, int e_id) {
+#ifdef MCF_CSR
+  return &mcf->adj_length[mcf->adj_pos[e_id]];
+#else
+  return &mcf->edges[e_id].length;
+#endif
+}
 static inline double get_L(MCF *mcf) { return mcf->L; }
 static inline int problem_type(MCF *mcf) { return mcf->_problem_type; }
 
@@ -186,5 +207,6 @@ void free_topology(MCF *mcf);
 void print_network_demands(MCF *mcf, bool print_only_edges);
 void print_backward_shortest_path(MCF *mcf, int t);
 void print_routing_paths(MCF *mcf);
+uint32_t checksum_flows(MCF *mcf);
 
 #endif
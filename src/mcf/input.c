@@ -0,0 +1,53 @@
+#include <bench.h>
+#include <bench_debug.h>
+#include <bench_malloc.h>
+#include <input.h>
+#include <klib.h>
+#include <stdint.h>
+
+#ifdef MCF_GEN
+
+// The blob written by test-gen/main.c, embedded by resources/resources-gen.S.
+extern const uint32_t mcf_graph_start[], mcf_graph_end[];
+
+#define MCFG_MAGIC 0x4746434d // "MCFG"
+#define MCFG_VERSION 1
+
+int nodes_num;
+int edges_num;
+int demands_num;
+node_t *node_buf;
+edge_t *edge_buf;
+demands_t *demands_buf;
+
+// Unpacks the blob into the arrays read by read_network_topology_and_demands.
+// This runs once, before the measured region.
+void input_init(void) {
+  const uint32_t *p = mcf_graph_start;
+  assert(p[0] == MCFG_MAGIC && p[1] == MCFG_VERSION);
+  nodes_num = p[2];
+  edges_num = p[3];
+  demands_num = p[4];
+  BENCH_LOG(INFO, "mcf graph: %d nodes, %d edges, %d demands, seed %d",
+            nodes_num, edges_num, demands_num, (int)p[5]);
+  p += 6;
+  assert(mcf_graph_end - p == nodes_num + 4 * edges_num + 3 * demands_num);
+
+  node_buf = bench_malloc(sizeof(node_t) * nodes_num);
+  edge_buf = bench_malloc(sizeof(edge_t) * edges_num);
+  demands_buf = bench_malloc(sizeof(demands_t) * demands_num);
+  assert(node_buf && edge_buf && demands_buf);
+
+  for (int i = 0; i < nodes_num; i++, p++)
+    node_buf[i] = (node_t){i, 0, 0, p[0]};
+  for (int i = 0; i < edges_num; i++, p += 4)
+    edge_buf[i] = (edge_t){i, p[0], p[1], p[2], p[3]};
+  for (int i = 0; i < demands_num; i++, p += 3)
+    demands_buf[i] = (demands_t){i, p[0], p[1], p[2]};
+}
+
+#else
+
+void input_init(void) {}
+
+#endif
@@ -12,11 +12,11 @@ extern int demands_select;
 //
 ////////////////////////////////////////////////////////////////////////////////
 
-int main(char *args) {
-  bench_malloc_init();
-  uint64_t start_time, end_time;
-  start_time = uptime();
+static uint32_t sum;
 
+// One solve of every demand set; the flows of each are folded into `sum`.
+static void mcf_run(void *arg) {
+  sum = 0;
   BENCH_LOG(DEBUG, "\nRandomized rounded paths: size: %d", sizeof(size_t));
   for (demands_select = 0; demands_select < demands_num; demands_select++) {
     // (1) run MCF solver;
@@ -45,12 +45,24 @@ int main(char *args) {
     // "damages" optimality and may violate capacities;
     do_randomized_rounding(&mcf);
     print_routing_paths(&mcf);
+    uint32_t sums[] = {sum, checksum_flows(&mcf)};
+    sum = checksum(sums, sums + 2);
 
     // (3) clean up
     free_topology(&mcf);
   }
-  end_time = uptime();
-  BENCH_LOG(INFO, "OpenPerf time: %s", format_time(end_time - start_time));
+}
+
+int main(char *args) {
+  bench_malloc_init();
+  input_init();
+  bench_perf perf;
+  bench_repeat(NULL, mcf_run, NULL, &perf);
+  BENCH_LOG(INFO, "OpenPerf time: %s%s", format_time(perf.time),
+            format_counters(&perf));
+  bench_malloc_report();
+  bench_region_report();
+  bench_result("mcf", edges_num, sum, &perf);
 
-  return 0;
+  return bench_verify(sum);
 }
@@ -61,10 +61,10 @@ void initialize(MCF *mcf, double delta, int flag) {
   }
   // init edge "length function" l(e)
   for (i = 0; i < mcf->no_edge; i++) {
-    mcf->edges[i].length = 0.0;
-    mcf->edges[i].length += mcf->edges[i]._Y_e;
-    mcf->edges[i].length +=
-        mcf->edges[i].latency * mcf->_phi_latency; // 0 for flag=0;
+    double *length = length_of_edge(mcf, i);
+    *length = 0.0;
+    *length += mcf->edges[i]._Y_e;
+    *length += mcf->edges[i].latency * mcf->_phi_latency; // 0 for flag=0;
   }
   // init commodities
   for (i = 0; i < mcf->no_commodity; i++) {
@@ -311,6 +311,8 @@ void update_dual_variables(MCF *mcf, int s, double epsilon, int flag) {
   double old_phi_latency;
   double temp_latency = 0.0;
 
+  BENCH_REGION_START("dual");
+
   // (1) accumulate temp_latency along the shortest paths for the
   // shortest paths tree for the commodities of this source node;
   mcf->_min_rd++;
@@ -348,13 +350,13 @@ void update_dual_variables(MCF *mcf, int s, double epsilon, int flag) {
 
   // (3) update the "length function";
   for (i = 0; i < mcf->no_edge; i++) {
-    mcf->edges[i].length += (mcf->edges[i]._Y_e - mcf->edges[i]._old_Y_e);
+    double *length = length_of_edge(mcf, i);
+    *length += (mcf->edges[i]._Y_e - mcf->edges[i]._old_Y_e);
     // the above length function is enough for "max concurrent flow" problem;
     // howver, if we solve "min-cost max concurrent flow", then, we must add
     // more to the length function;
     if (flag != 0) { // 1
-      mcf->edges[i].length +=
-          mcf->edges[i].latency * (mcf->_phi_latency - old_phi_latency);
+      *length += mcf->edges[i].latency * (mcf->_phi_latency - old_phi_latency);
     }
   }
 
@@ -372,13 +374,14 @@ void update_dual_variables(MCF *mcf, int s, double epsilon, int flag) {
     mcf->_temp_edge_flow[i] = 0.0;
   }
 
+  BENCH_REGION_STOP("dual");
   return;
 }
 
 void scale_down_linear(MCF *mcf, float times) {
   // Note: currently not used;
   for (int i = 0; i < mcf->no_edge; i++) {
-    mcf->edges[i].length /= times;
+    *length_of_edge(mcf, i) /= times;
     mcf->edges[i]._Y_e /= times;
   }
   mcf->_phi_latency /= times;
@@ -739,6 +742,8 @@ void shortest_paths(MCF *mcf_v, int s, int num_commodities, int *dest_flag) {
   // num_commodities is the number of commodities that still need
   // routing for this source;
 
+  BENCH_REGION_START("dijkstra");
+
   int num_commodities_to_process = num_commodities;
   PQDATUM wf, wf1; // WAVEFRONTS;
   PQDATUM_init(&wf);
@@ -781,16 +786,27 @@ void shortest_paths(MCF *mcf_v, int s, int num_commodities, int *dest_flag) {
       break;
 
     mcf_v->nodes[v].dij_visited = mcf_v->_rd;
-    for (int i = 0; i < mcf_v->nodes[v].no_edge; i++) {
-      w = mcf_v->edges[mcf_v->nodes[v].edges[i]].dest;
+#ifdef MCF_CSR
+    int first = mcf_v->adj_start[v], last = mcf_v->adj_start[v + 1];
+#else
+    int first = 0, last = mcf_v->nodes[v].no_edge;
+#endif
+    for (int i = first; i < last; i++) {
+#ifdef MCF_CSR
+      int e = mcf_v->adj_edge[i];
+      double length = mcf_v->adj_length[i];
+      w = mcf_v->adj_dest[i];
+#else
+      int e = mcf_v->nodes[v].edges[i];
+      double length = mcf_v->edges[e].length;
+      w = mcf_v->edges[e].dest;
+#endif
       if (mcf_v->nodes[w].dij_visited != mcf_v->_rd)
         if (mcf_v->nodes[w].dij_updated != mcf_v->_rd ||
-            mcf_v->nodes[w].dist >
-                dist(&wf1) + mcf_v->edges[mcf_v->nodes[v].edges[i]].length) {
+            mcf_v->nodes[w].dist > dist(&wf1) + length) {
           mcf_v->nodes[w].pre = v;
-          mcf_v->nodes[w].pre_edge = mcf_v->nodes[v].edges[i];
-          mcf_v->nodes[w].dist =
-              dist(&wf1) + mcf_v->edges[mcf_v->nodes[v].edges[i]].length;
+          mcf_v->nodes[w].pre_edge = e;
+          mcf_v->nodes[w].dist = dist(&wf1) + length;
           set_node(&wf, w);
           set_dist(&wf, mcf_v->nodes[w].dist);
           if (mcf_v->nodes[w].dij_updated != mcf_v->_rd) {
@@ -803,6 +819,8 @@ void shortest_paths(MCF *mcf_v, int s, int num_commodities, int *dest_flag) {
     }
   }
   pqfree(&pq, pos); // clean up;
+
+  BENCH_REGION_STOP("dijkstra");
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -918,6 +936,37 @@ void read_network_topology_and_demands(MCF *mcf_v, double rate) {
     mcf_v->nodes[index].no_edge++;
   }
 
+#ifdef MCF_CSR
+  // (3b) the same adjacency in CSR form, filled from nodes[].edges so that
+  // Dijkstra visits the edges of every node in the same order;
+  int n = mcf_v->no_node, m = mcf_v->no_edge;
+  mcf_v->adj_start = (int *)bench_malloc(sizeof(int) * (n + 1));
+  mcf_v->adj_pos = (int *)bench_malloc(sizeof(int) * m);
+  mcf_v->adj_edge = (int *)bench_malloc(sizeof(int) * m);
+  mcf_v->adj_dest = (int *)bench_malloc(sizeof(int) * m);
+  mcf_v->adj_length = (double *)bench_malloc(sizeof(double) * m);
+  if (mcf_v->adj_start == NULL || mcf_v->adj_pos == NULL ||
+      mcf_v->adj_edge == NULL || mcf_v->adj_dest == NULL ||
+      mcf_v->adj_length == NULL) {
+    bench_printf("\nError: Unable to bench_malloc <adj>.\n");
+    assert(0);
+  }
+  mcf_v->adj_start[0] = 0;
+  for (int i = 0; i < n; i++) {
+    mcf_v->adj_start[i + 1] = mcf_v->adj_start[i] + mcf_v->nodes[i].no_edge;
+  }
+  for (int i = 0; i < n; i++) {
+    for (int j = 0; j < mcf_v->nodes[i].no_edge; j++) {
+      int e = mcf_v->nodes[i].edges[j];
+      int pos = mcf_v->adj_start[i] + j;
+      mcf_v->adj_pos[e] = pos;
+      mcf_v->adj_edge[pos] = e;
+      mcf_v->adj_dest[pos] = mcf_v->edges[e].dest;
+      mcf_v->adj_length[pos] = 0.0;
+    }
+  }
+#endif
+
   // (4) read demands/commodities;
   double amount;
   mcf_v->no_commodity = 1; // demands_num;
@@ -999,6 +1048,14 @@ void free_topology(MCF *mcf_v) {
   }
   bench_free(mcf_v->nodes);
 
+#ifdef MCF_CSR
+  bench_free(mcf_v->adj_start);
+  bench_free(mcf_v->adj_pos);
+  bench_free(mcf_v->adj_edge);
+  bench_free(mcf_v->adj_dest);
+  bench_free(mcf_v->adj_length);
+#endif
+
   return;
 }
 
@@ -1073,6 +1130,18 @@ void print_routing_paths(MCF *mcf_v) {
   bench_printf("\n");
 }
 
+uint32_t checksum_flows(MCF *mcf_v) {
+  // checksum of the total flow of every edge, i.e. the solver's result;
+  double *flows = (double *)bench_malloc(sizeof(double) * mcf_v->no_edge);
+  assert(flows);
+  for (int i = 0; i < mcf_v->no_edge; i++) {
+    flows[i] = mcf_v->edges[i].flow;
+  }
+  uint32_t sum = checksum(flows, flows + mcf_v->no_edge);
+  bench_free(flows);
+  return sum;
+}
+
 void print_backward_shortest_path(MCF *mcf_v, int dest) {
   // debug only;
   int t = dest;
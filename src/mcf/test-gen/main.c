@@ -1,122 +1,182 @@
+// Generates an input graph for mcf as a binary blob, embedded in the image by
+// resources/resources-gen.S and read by input_init().
+//
+// Usage: test-gen [-n nodes] [-d degree] [-k demands] [-s seed] -o <file>
+//
+// Node i has an edge to i + 1, so every node reaches every later one and every
+// demand can be routed, and a number of branches to later nodes drawn from a
+// Lomax (Pareto II) distribution of mean `degree - 1`: most nodes have a few
+// branches, a few hubs have hundreds. Three branches in four go to a nearby
+// node, the others anywhere after it. The first demand goes from the first to
+// the last node, the others between random pairs. The output depends only on
+// the arguments.
+//
+// The blob is a sequence of little-endian 32-bit words:
+//   magic "MCFG", version, nodes, edges, demands, seed
+//   nodes x   {edge_num}
+//   edges x   {src, dest, capacity, delay}   (sorted by src)
+//   demands x {src, dest, amount}
+
+#include <assert.h>
+#include <math.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
-#include <sys/time.h>
+#include <unistd.h>
+
+#define MCFG_MAGIC 0x4746434d // "MCFG"
+#define MCFG_VERSION 1
+
+// Branches of one node, and the distance of a nearby destination.
+#define MAX_BRANCH 1024
+#define NEAR 64
+
+static uint64_t rng_state;
+
+// splitmix64, so that the graph is the same on every host.
+static uint64_t rng() {
+  uint64_t z = (rng_state += 0x9e3779b97f4a7c15ull);
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+  return z ^ (z >> 31);
+}
+
+// Uniform in [lo, hi].
+static uint32_t rng_range(uint32_t lo, uint32_t hi) {
+  return lo + rng() % ((uint64_t)hi - lo + 1);
+}
+
+// Uniform in (0, 1].
+static double rng_unit() { return ((rng() >> 11) + 1) * 0x1p-53; }
+
+static void put(FILE *fp, uint32_t w) {
+  uint8_t b[4] = {w, w >> 8, w >> 16, w >> 24};
+  fwrite(b, 1, 4, fp);
+}
+
+typedef struct {
+  uint32_t src, dest, capacity, delay;
+} edge_t;
+
+static void usage(const char *prog) {
+  fprintf(stderr,
+          "usage: %s [-n nodes] [-d degree] [-k demands] [-s seed] -o file\n",
+          prog);
+  exit(1);
+}
 
 int main(int argc, char *argv[]) {
-  struct timeval tv_start;
-  int node_num = 10;
-  int edge_num = 0;
-  int demands_num = 1;
-
-  gettimeofday(&tv_start, NULL);
-  srand(tv_start.tv_usec);
-
-  FILE *fp = fopen("test.c", "w");
-  fprintf(fp,
-          "#include \"input.h\"\n\n"); // 记录此时的偏移，最后需要打印三个变量
-  int num_write = ftell(fp);
-  int edge_num_write = 0;
-
-  if (argv[1]) {
-    node_num = atoi(argv[1]);
-  }
+  uint32_t nodes = 10000, demands = 4, seed = 1;
+  double degree = 4;
+  const char *out = NULL;
 
-  int edge_num_offset_buf[node_num]; // 记录每个节点的edge打印位置
-  // ******************************************* 先来占位，最后再写入
-  // ******************************************* //
-  fprintf(fp, "const int nodes_num   = %5d;\n", 0);
-  fprintf(fp, "const int edges_num   = %5d;\n", 0);
-  fprintf(fp, "const int demands_num = %5d;\n\n", 0);
-  // ******************************************* 生成结点
-  // ******************************************* //
-  fprintf(fp, "node_t node_buf[]={\n");
-  for (int i = 0; i < node_num; i++) {
-    fprintf(fp, "\t{%5d, %5d, %5d,", i, 0, 0);
-    edge_num_offset_buf[i] = ftell(fp);
-    fprintf(fp, " %5d},\n", 1);
-  }
-  fprintf(fp, "};\n\n");
-  // ******************************************* 生成边
-  // ******************************************* //
-  edge_num = 0;
-  fprintf(fp, "edge_t edge_buf[]={\n");
-  for (int i = 0; i < node_num - 1;
-       i++) // 初始化初始通路  ，初始通路必定能满足条件
-  {
-    int capacity = rand() % 99 + 100; // 容量
-    int delay = rand() % 451 + 50;    // 花费
-    fprintf(fp, "\t{%5d, %5d, %5d, %5d, %5d},\n", edge_num, i, i + 1, capacity,
-            delay);
-    edge_num++;
+  int opt;
+  while ((opt = getopt(argc, argv, "n:d:k:s:o:")) != -1) {
+    switch (opt) {
+    case 'n':
+      nodes = strtoul(optarg, NULL, 0);
+      break;
+    case 'd':
+      degree = strtod(optarg, NULL);
+      break;
+    case 'k':
+      demands = strtoul(optarg, NULL, 0);
+      break;
+    case 's':
+      seed = strtoul(optarg, NULL, 0);
+      break;
+    case 'o':
+      out = optarg;
+      break;
+    default:
+      usage(argv[0]);
+    }
   }
+  if (out == NULL || nodes < 2 || degree < 1 || demands < 1)
+    usage(argv[0]);
+  rng_state = seed;
+
+  uint32_t *edge_num = calloc(nodes, sizeof(uint32_t));
+  size_t cap = (size_t)nodes * degree + MAX_BRANCH, nedges = 0;
+  edge_t *edges = malloc(cap * sizeof(edge_t));
+  assert(edge_num && edges);
 
-  for (int start_node = 0; start_node < node_num - 1; start_node++) // 生成分支
-  {
-    int len2end = (node_num - 1) - start_node; // 到终点的距离
-    int base = len2end > 7 ? 7 : len2end;
-    int branch_num =
-        (rand() % 4 == 1) ? rand() % base : 0; // 产生多少条分支，75%概率不生成
-    int node_write[len2end]; // 计分表，保证通路不重复
-
-    fseek(fp, edge_num_offset_buf[start_node], SEEK_SET);
-    fprintf(fp, " %5d", branch_num + 1); // 一条原路与branch_num条支路
-    fseek(fp, 0, SEEK_END);
-
-    for (int i = 0; i < len2end; i++)
-      node_write[i] = 0;
-
-    for (int i = 0; i < branch_num; i++) // 分支，不保证能用
-    {
-      int capacity = rand() % 255 + 1; // 容量
-      int delay = rand() % 500 + 1;    // 花费
-      int end_node;
-      do {
-        end_node = rand() % (len2end - 1) + start_node + 1;
-      } while (node_write[end_node - start_node - 1] == 1); // 只能向后生成
-      node_write[end_node - start_node - 1] = 1; // 不能重复
-      fprintf(fp, "\t{%5d, %5d, %5d, %5d, %5d},\n", edge_num, start_node,
-              end_node, capacity, delay);
-      edge_num++; // 输出完成后再加
+  uint32_t dest[MAX_BRANCH];
+  for (uint32_t i = 0; i + 1 < nodes; i++) {
+    uint32_t after = nodes - 1 - i; // nodes after i
+    edges[nedges++] = (edge_t){i, i + 1, rng_range(100, 198),
+                               rng_range(50, 500)};
+    double lomax = (degree - 1) * (1 / sqrt(rng_unit()) - 1);
+    uint32_t nbranch = lomax < MAX_BRANCH ? lomax + 0.5 : MAX_BRANCH;
+    if (nbranch > after - 1)
+      nbranch = after - 1;
+
+    // Distinct destinations other than i + 1; give up on a branch after a
+    // few collisions, which only happens when few nodes are left.
+    uint32_t n = 0;
+    for (uint32_t b = 0; b < nbranch; b++) {
+      for (int tries = 0; tries < 8; tries++) {
+        uint32_t d = rng() % 4 != 0 && after > 2
+                         ? i + rng_range(2, after < NEAR ? after : NEAR)
+                         : rng_range(i + 2, nodes - 1);
+        int dup = 0;
+        for (uint32_t j = 0; j < n && !dup; j++)
+          dup = dest[j] == d;
+        if (!dup) {
+          dest[n++] = d;
+          break;
+        }
+      }
     }
-  }
-  fprintf(fp, "};\n\n");
-  // ******************************************* 生成目标
-  // ******************************************* //
-
-  fprintf(fp, "demands_t demands_buf[]={\n");
-  fprintf(fp, "\t{%5d, %5d, %5d, %5d},\n", 0, 0, node_num - 1,
-          10); // 打印第一个目标，该目标为固定值
-
-  for (int start_node = 0; start_node < node_num - 1; start_node++) // 生成分支
-  {
-    int len2end = (node_num - 1) - start_node; // 到终点的距离
-    int base = len2end > 15 ? 15 : len2end;
-    int branch_num = rand() % base; // 该起点产生多少条需求
-    int node_write[len2end];        // 计分表，保证通路不重复
-    for (int i = 0; i < len2end; i++)
-      node_write[i] = 0;
-
-    for (int i = 0; i < branch_num; i++) // 开始生成
-    {
-      int demands = rand() % 100 + 1; // 需求容量
-      int end_node;
-      do {
-        end_node = rand() % len2end + start_node + 1;
-      } while (node_write[end_node - start_node - 1] == 1); // 只能向后生成
-      node_write[end_node - start_node - 1] = 1; // 不能重复
-      fprintf(fp, "\t{%5d, %5d, %5d, %5d},\n", demands_num, start_node,
-              end_node, demands);
-      demands_num++; // 输出完成后再加
+    if (nedges + n > cap) {
+      cap = cap * 2 + n;
+      edges = realloc(edges, cap * sizeof(edge_t));
+      assert(edges);
     }
+    for (uint32_t j = 0; j < n; j++)
+      edges[nedges++] = (edge_t){i, dest[j], rng_range(1, 255),
+                                 rng_range(1, 500)};
+    edge_num[i] = n + 1;
   }
-  fprintf(fp, "};\n");
+  // The last node has no edges, but mcf allocates at least one slot.
+  edge_num[nodes - 1] = 1;
 
-  // *******************************************
-  // ******************************************* //
-  fseek(fp, num_write, SEEK_SET);
-  fprintf(fp, "const int nodes_num   = %5d;\n", node_num);
-  fprintf(fp, "const int edges_num   = %5d;\n", edge_num);
-  fprintf(fp, "const int demands_num = %5d;\n\n", demands_num);
+  FILE *fp = fopen(out, "wb");
+  if (fp == NULL) {
+    perror(out);
+    return 1;
+  }
+  put(fp, MCFG_MAGIC);
+  put(fp, MCFG_VERSION);
+  put(fp, nodes);
+  put(fp, nedges);
+  put(fp, demands);
+  put(fp, seed);
+  for (uint32_t i = 0; i < nodes; i++)
+    put(fp, edge_num[i]);
+  for (size_t i = 0; i < nedges; i++) {
+    put(fp, edges[i].src);
+    put(fp, edges[i].dest);
+    put(fp, edges[i].capacity);
+    put(fp, edges[i].delay);
+  }
+  put(fp, 0);
+  put(fp, nodes - 1);
+  put(fp, 10);
+  for (uint32_t i = 1; i < demands; i++) {
+    uint32_t src = rng_range(0, nodes - 2);
+    put(fp, src);
+    put(fp, rng_range(src + 1, nodes - 1));
+    put(fp, rng_range(1, 100));
+  }
+  if (fclose(fp) != 0) {
+    perror(out);
+    return 1;
+  }
 
-  fclose(fp);
+  printf("%s: %u nodes, %zu edges, %u demands, seed %u\n", out, nodes, nedges,
+         demands, seed);
+  free(edges);
+  free(edge_num);
+  return 0;
 }
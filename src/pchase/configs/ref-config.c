@@ -0,0 +1,9 @@
+#include <pchase.h>
+
+bench_pchase_config config = {.footprint_min = 4,
+                              .footprint_max = 8192,
+                              .stride = 64,
+                              .loads = 1048576};
+
+Setting bench_setting = {.sub_config = &config, .checksum = 0x6204c877,
+                         .ref_time = 410291};
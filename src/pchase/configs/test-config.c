@@ -0,0 +1,9 @@
+#include <pchase.h>
+
+bench_pchase_config config = {.footprint_min = 4,
+                              .footprint_max = 1024,
+                              .stride = 64,
+                              .loads = 262144};
+
+Setting bench_setting = {.sub_config = &config, .checksum = 0x07677494,
+                         .ref_time = 15628};
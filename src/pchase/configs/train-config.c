@@ -0,0 +1,9 @@
+#include <pchase.h>
+
+bench_pchase_config config = {.footprint_min = 4,
+                              .footprint_max = 256,
+                              .stride = 64,
+                              .loads = 65536};
+
+Setting bench_setting = {.sub_config = &config, .checksum = 0x0c2d7dcf,
+                         .ref_time = 2994};
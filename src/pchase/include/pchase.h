@@ -0,0 +1,21 @@
+#ifndef _PCHASE_H_
+#define _PCHASE_H_
+
+#include <am.h>
+#include <bench.h>
+#include <bench_malloc.h>
+#include <klib-macros.h>
+#include <klib.h>
+#include <stdint.h>
+
+typedef struct {
+  // Footprints doubling from footprint_min to footprint_max KiB.
+  uint32_t footprint_min;
+  uint32_t footprint_max;
+  // Distance in bytes between the pointers of the chain, at least a pointer.
+  uint32_t stride;
+  // Timed loads per footprint, at least one walk of the whole chain.
+  uint32_t loads;
+} bench_pchase_config;
+
+#endif
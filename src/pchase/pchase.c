@@ -0,0 +1,99 @@
+#include <bench_debug.h>
+#include <pchase.h>
+
+// Load-to-use latency by footprint. The slots of a footprint, `stride` bytes
+// apart, are linked into one random cycle (Sattolo's algorithm), and every
+// load takes its address from the previous one. Loads cannot overlap and the
+// order defeats the prefetchers, so the time per load is the latency of the
+// level the footprint fits in.
+
+extern bench_pchase_config config;
+
+// bench_rand() has 15 bits, two of them cover every slot index. The calls
+// are sequenced, so the cycle does not depend on the compiler.
+static uint32_t rand30() {
+  uint32_t hi = bench_rand();
+  return (hi << 15) | bench_rand();
+}
+
+static void build_cycle(char *buf, uint32_t *perm, size_t n, size_t stride) {
+  for (size_t i = 0; i < n; i++)
+    perm[i] = i;
+  for (size_t i = n - 1; i > 0; i--) {
+    size_t j = rand30() % i;
+    uint32_t t = perm[i];
+    perm[i] = perm[j];
+    perm[j] = t;
+  }
+  for (size_t i = 0; i < n; i++)
+    *(void **)(buf + i * stride) = buf + perm[i] * stride;
+}
+
+// `loads` is a multiple of 8.
+static void *chase(void *p, size_t loads) {
+  for (size_t i = 0; i < loads; i += 8) {
+    p = *(void **)p;
+    p = *(void **)p;
+    p = *(void **)p;
+    p = *(void **)p;
+    p = *(void **)p;
+    p = *(void **)p;
+    p = *(void **)p;
+    p = *(void **)p;
+  }
+  return p;
+}
+
+int main() {
+  bench_malloc_init();
+  size_t stride = config.stride;
+  size_t nmax = (size_t)config.footprint_max * 1024 / stride;
+  assert(stride >= sizeof(void *));
+  assert(config.footprint_min * 1024 / stride >= 2);
+
+  char *buf = bench_malloc(nmax * stride);
+  uint32_t *perm = bench_malloc(nmax * sizeof(uint32_t));
+  assert(buf);
+  assert(perm);
+  bench_srand(1);
+
+  bench_perf perf, total = {0};
+  uint64_t loads_total = 0;
+  uint32_t sum = 0;
+
+  printf("Footprint   ns/load   cycles/load\n");
+  for (uint32_t kib = config.footprint_min; kib <= config.footprint_max;
+       kib *= 2) {
+    size_t n = (size_t)kib * 1024 / stride;
+    size_t loads = ROUNDUP(config.loads > n ? config.loads : n, 8);
+    build_cycle(buf, perm, n, stride);
+
+    // One untimed walk of the chain brings the footprint into the caches.
+    void *p = chase(buf, ROUNDUP(n, 8));
+    bench_perf_begin(&perf);
+    p = chase(p, loads);
+    bench_perf_end(&perf);
+
+    total.time += perf.time;
+    total.cycles += perf.cycles;
+    total.instret += perf.instret;
+    total.valid = perf.valid;
+    loads_total += loads;
+    uint32_t sums[] = {sum, ((char *)p - buf) / stride};
+    sum = checksum(sums, sums + 2);
+
+    printf("%7d KiB  %8.2f", kib, 1000.0 * perf.time / loads);
+    if (perf.valid & BENCH_PERF_CYCLES)
+      printf("  %12.2f", (double)perf.cycles / loads);
+    printf("\n");
+  }
+
+  bench_free(perm);
+  bench_free(buf);
+
+  BENCH_LOG(INFO, "OpenPerf time: %s%s", format_time(total.time),
+            format_counters(&total));
+  bench_malloc_report();
+  bench_result("pchase", loads_total, sum, &total);
+  return bench_verify(sum);
+}
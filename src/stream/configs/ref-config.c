@@ -1,3 +1,13 @@
+#include <bench.h>
 #include <stream.h>
 
-bench_stream_config config = {200000};
+bench_stream_config config = {.stream_array_size = 200000,
+                              .ntimes = 10,
+                              .sweep_min = 4,
+                              .sweep_max = 4096,
+                              .kernels = STREAM_SUM | STREAM_FILL |
+                                         STREAM_STRIDE | STREAM_GATHER,
+                              .stride = 8};
+
+Setting bench_setting = {.sub_config = &config, .checksum = 0x25a89f83,
+                         .ref_time = 1645};
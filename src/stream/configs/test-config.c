@@ -1,3 +1,13 @@
+#include <bench.h>
 #include <stream.h>
 
-bench_stream_config config = {100000};
+bench_stream_config config = {.stream_array_size = 100000,
+                              .ntimes = 10,
+                              .sweep_min = 4,
+                              .sweep_max = 1024,
+                              .kernels = STREAM_SUM | STREAM_FILL |
+                                         STREAM_STRIDE | STREAM_GATHER,
+                              .stride = 8};
+
+Setting bench_setting = {.sub_config = &config, .checksum = 0xd33b31ab,
+                         .ref_time = 668};
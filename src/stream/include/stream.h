@@ -1,4 +1,16 @@
+// Optional kernels in bench_stream_config.kernels, next to the four STREAM
+// kernels that always run.
+#define STREAM_SUM (1 << 0)    // s += a[j], read only
+#define STREAM_FILL (1 << 1)   // c[j] = scalar, write only
+#define STREAM_STRIDE (1 << 2) // Sum in `stride` interleaved passes
+#define STREAM_GATHER (1 << 3) // Sum through a random index array
 
 typedef struct {
   unsigned int stream_array_size;
+  // Iterations of every kernel, the first is not counted. 0 means NTIMES.
+  unsigned int ntimes;
+  // Working-set range in KiB of the STREAM_SWEEP=1 sweep.
+  unsigned int sweep_min, sweep_max;
+  unsigned int kernels;
+  unsigned int stride;
 } bench_stream_config;
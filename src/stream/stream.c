@@ -44,6 +44,7 @@
 #include <bench.h>
 #include <bench_debug.h>
 #include <bench_malloc.h>
+#include <bench_mem.h>
 #include <float.h>
 #include <klib-macros.h>
 #include <klib.h>
@@ -104,6 +105,7 @@
  *         increase the reported performance.
  *      NTIMES can also be set on the compile line without changing the source
  *         code using, for example, "-DNTIMES=7".
+ *      Here it is only the default for inputs whose config has no ntimes.
  */
 #ifdef NTIMES
 #if NTIMES <= 1
@@ -184,11 +186,24 @@
 // OFFSET],
 //  c[STREAM_ARRAY_SIZE + OFFSET];
 
-static double avgtime[4] = {0}, maxtime[4] = {0},
-              mintime[4] = {FLT_MAX, FLT_MAX, FLT_MAX, FLT_MAX};
+/* The four STREAM kernels and the optional ones of config.kernels: Sum
+ * (read only), Fill (write only), Stride (Sum in `config.stride` interleaved
+ * passes) and Gather (Sum through a random permutation of the indices).
+ */
+#define NKERNELS 8
+#define KERNEL_ON(j) ((j) < 4 || (config.kernels & (1 << ((j)-4))))
+
+static double avgtime[NKERNELS] = {0}, maxtime[NKERNELS] = {0},
+              mintime[NKERNELS] = {FLT_MAX, FLT_MAX, FLT_MAX, FLT_MAX,
+                                   FLT_MAX, FLT_MAX, FLT_MAX, FLT_MAX};
+
+static char *label[NKERNELS] = {"Copy:      ", "Scale:     ", "Add:       ",
+                                "Triad:     ", "Sum:       ", "Fill:      ",
+                                "Stride:    ", "Gather:    "};
 
-static char *label[4] = {
-    "Copy:      ", "Scale:     ", "Add:       ", "Triad:     "};
+/* results of Sum, Stride and Gather in the last iteration */
+static STREAM_TYPE reduced[3];
+static const int reduce_kernel[3] = {4, 6, 7};
 
 // static double bytes[4] = {2 * sizeof(STREAM_TYPE) * STREAM_ARRAY_SIZE,
 //                        2 * sizeof(STREAM_TYPE) * STREAM_ARRAY_SIZE,
@@ -196,7 +211,11 @@ static char *label[4] = {
 //                        3 * sizeof(STREAM_TYPE) * STREAM_ARRAY_SIZE};
 
 extern double mysecond();
+static double rate(double bytes, double t);
 extern void checkSTREAMresults();
+#ifdef STREAM_SWEEP
+static void stream_sweep(int ntimes);
+#endif
 #ifndef DIS_OPENMP
 #ifdef _OPENMP
 extern int omp_get_num_threads();
@@ -205,24 +224,120 @@ extern int omp_get_num_threads();
 
 extern const bench_stream_config config;
 
+#define NTIMES_MAX 100
+
+/* State of the run, shared by all harts */
+static int asize, ntimes;
+static STREAM_TYPE *a, *b, *c;
+static uint32_t *idx;
+static double bytes[NKERNELS];
+/* each kernel run is timed with bench_perf, which adds cycles where the
+ * platform can count them (see bench_perf_read()) */
+static bench_perf kperf[NKERNELS][NTIMES_MAX];
+
+/* With STREAM_MPE=1 every hart runs each kernel on its own contiguous part of
+ * the arrays, between barriers, so kperf[][] (timed on hart 0 from barrier to
+ * barrier) is the aggregate and hart_time[][] the best time of every hart on
+ * its part. Without MPE, or on a platform with one CPU, there is one hart.
+ */
+#define STREAM_MAX_CPU 16
+
+static int ncpu = 1;
+static uint64_t hart_time[STREAM_MAX_CPU][NKERNELS];
+static STREAM_TYPE partial[STREAM_MAX_CPU];
+
+#ifdef STREAM_MPE
+static int bar_lock, bar_count;
+static volatile int bar_sense;
+static int hart_sense[STREAM_MAX_CPU];
+
+/* sense-reversing barrier on AM's atomic_xchg */
+static void barrier(int me) {
+  int sense = hart_sense[me] = !hart_sense[me];
+  while (atomic_xchg(&bar_lock, 1))
+    ;
+  __sync_synchronize();
+  if (++bar_count == ncpu) {
+    bar_count = 0;
+    __sync_synchronize();
+    atomic_xchg(&bar_lock, 0);
+    bar_sense = sense;
+  } else {
+    __sync_synchronize();
+    atomic_xchg(&bar_lock, 0);
+    while (bar_sense != sense)
+      ;
+  }
+  __sync_synchronize();
+}
+#else
+static void barrier(int me) {}
+#endif
+
+static uint64_t kernel_begin(int j, int k, int me) {
+  barrier(me);
+  if (me == 0)
+    bench_perf_begin(&kperf[j][k]);
+  return ncpu > 1 ? uptime() : 0;
+}
+
+static void kernel_end(int j, int k, int me, uint64_t t0) {
+  if (ncpu > 1) {
+    uint64_t t = uptime() - t0;
+    if (k > 0 && (hart_time[me][j] == 0 || t < hart_time[me][j]))
+      hart_time[me][j] = t;
+  }
+  barrier(me);
+  if (me == 0)
+    bench_perf_end(&kperf[j][k]);
+}
+
+static STREAM_TYPE sum_partial() {
+  STREAM_TYPE s = 0.0;
+  for (int i = 0; i < ncpu; i++)
+    s += partial[i];
+  return s;
+}
+
+static void stream_kernels(int me);
+static int stream_report();
+
+#ifdef STREAM_MPE
+static void stream_mp() {
+  int me = cpu_current();
+  if (me < ncpu)
+    stream_kernels(me);
+  if (me != 0)
+    while (1)
+      ;
+  halt(stream_report());
+}
+#endif
+
 int main() {
-  int asize = config.stream_array_size;
+  asize = config.stream_array_size;
+  ntimes = config.ntimes ? config.ntimes : NTIMES;
   bench_malloc_init();
-  STREAM_TYPE *a = bench_malloc(sizeof(STREAM_TYPE) * (asize + OFFSET));
-  STREAM_TYPE *b = bench_malloc(sizeof(STREAM_TYPE) * (asize + OFFSET));
-  STREAM_TYPE *c = bench_malloc(sizeof(STREAM_TYPE) * (asize + OFFSET));
+  a = bench_malloc(sizeof(STREAM_TYPE) * (asize + OFFSET));
+  b = bench_malloc(sizeof(STREAM_TYPE) * (asize + OFFSET));
+  c = bench_malloc(sizeof(STREAM_TYPE) * (asize + OFFSET));
+
+  bytes[0] = 2 * sizeof(STREAM_TYPE) * asize;
+  bytes[1] = 2 * sizeof(STREAM_TYPE) * asize;
+  bytes[2] = 3 * sizeof(STREAM_TYPE) * asize;
+  bytes[3] = 3 * sizeof(STREAM_TYPE) * asize;
+  bytes[4] = 1 * sizeof(STREAM_TYPE) * asize;
+  bytes[5] = 1 * sizeof(STREAM_TYPE) * asize;
+  bytes[6] = 1 * sizeof(STREAM_TYPE) * asize;
+  bytes[7] = (sizeof(STREAM_TYPE) + sizeof(uint32_t)) * asize;
 
-  double bytes[4] = {
-      2 * sizeof(STREAM_TYPE) * asize, 2 * sizeof(STREAM_TYPE) * asize,
-      3 * sizeof(STREAM_TYPE) * asize, 3 * sizeof(STREAM_TYPE) * asize};
-
-  STREAM_TYPE *vptr[] = {a, b, c};
   int quantum, checktick();
   // int BytesPerWord;
+#ifdef _OPENMP
   int k;
-  size_t j;
-  STREAM_TYPE scalar;
-  double t, times[4][NTIMES];
+#endif
+  size_t j, o;
+  double t;
 
   /* --- SETUP --- determine precision and check timing --- */
 
@@ -291,6 +406,21 @@ int main() {
     c[j] = 0.0;
   }
 
+  if (config.kernels & STREAM_STRIDE)
+    assert(config.stride > 0);
+  if (config.kernels & STREAM_GATHER) {
+    idx = bench_malloc(sizeof(uint32_t) * asize);
+    for (j = 0; j < asize; j++)
+      idx[j] = j;
+    bench_srand(1);
+    for (j = asize - 1; j > 0; j--) {
+      o = ((bench_rand() << 15) | bench_rand()) % (j + 1);
+      uint32_t tmp = idx[j];
+      idx[j] = idx[o];
+      idx[o] = tmp;
+    }
+  }
+
   printf(HLINE);
 
   if ((quantum = checktick()) >= 1)
@@ -325,75 +455,280 @@ int main() {
   printf("precision of your system timer.\n");
   printf(HLINE);
 
-  /*	--- MAIN LOOP --- repeat test cases NTIMES times --- */
+  if (ntimes < 2 || ntimes > NTIMES_MAX) {
+    BENCH_LOG(WARN, "ntimes = %d, using %d", ntimes,
+              MIN(MAX(ntimes, 2), NTIMES_MAX));
+    ntimes = MIN(MAX(ntimes, 2), NTIMES_MAX);
+  }
 
-  scalar = 3.0;
-  for (k = 0; k < NTIMES; k++) {
-    times[0][k] = mysecond();
-#ifndef DIS_OPENMP
-#pragma omp parallel for
+#ifdef STREAM_MPE
+  ncpu = MIN(cpu_count(), STREAM_MAX_CPU);
+  mpe_init(stream_mp);
 #endif
-    for (j = 0; j < asize; j++)
+  stream_kernels(0);
+  return stream_report();
+}
+
+/*	--- MAIN LOOP --- repeat test cases ntimes times --- */
+static void stream_kernels(int me) {
+  size_t lo = (size_t)asize * me / ncpu, hi = (size_t)asize * (me + 1) / ncpu;
+  size_t j, o;
+  STREAM_TYPE scalar = 3.0, s;
+  uint64_t t0;
+
+  barrier(me);
+  for (int k = 0; k < ntimes; k++) {
+    t0 = kernel_begin(0, k, me);
+    for (j = lo; j < hi; j++)
       c[j] = a[j];
-    times[0][k] = mysecond() - times[0][k];
+    kernel_end(0, k, me, t0);
 
-    times[1][k] = mysecond();
-#ifndef DIS_OPENMP
-#pragma omp parallel for
-#endif
-    for (j = 0; j < asize; j++)
+    t0 = kernel_begin(1, k, me);
+    for (j = lo; j < hi; j++)
       b[j] = scalar * c[j];
-    times[1][k] = mysecond() - times[1][k];
+    kernel_end(1, k, me, t0);
 
-    times[2][k] = mysecond();
-#ifndef DIS_OPENMP
-#pragma omp parallel for
-#endif
-    for (j = 0; j < asize; j++)
+    t0 = kernel_begin(2, k, me);
+    for (j = lo; j < hi; j++)
       c[j] = a[j] + b[j];
-    times[2][k] = mysecond() - times[2][k];
+    kernel_end(2, k, me, t0);
 
-    times[3][k] = mysecond();
-#ifndef DIS_OPENMP
-#pragma omp parallel for
-#endif
-    for (j = 0; j < asize; j++)
+    t0 = kernel_begin(3, k, me);
+    for (j = lo; j < hi; j++)
       a[j] = b[j] + scalar * c[j];
-    times[3][k] = mysecond() - times[3][k];
+    kernel_end(3, k, me, t0);
+
+    if (config.kernels & STREAM_SUM) {
+      t0 = kernel_begin(4, k, me);
+      s = 0.0;
+      for (j = lo; j < hi; j++)
+        s += a[j];
+      partial[me] = s;
+      kernel_end(4, k, me, t0);
+      if (me == 0)
+        reduced[0] = sum_partial();
+    }
+
+    if (config.kernels & STREAM_FILL) {
+      t0 = kernel_begin(5, k, me);
+      for (j = lo; j < hi; j++)
+        c[j] = scalar;
+      kernel_end(5, k, me, t0);
+    }
+
+    if (config.kernels & STREAM_STRIDE) {
+      t0 = kernel_begin(6, k, me);
+      s = 0.0;
+      for (o = 0; o < config.stride; o++)
+        for (j = lo + o; j < hi; j += config.stride)
+          s += a[j];
+      partial[me] = s;
+      kernel_end(6, k, me, t0);
+      if (me == 0)
+        reduced[1] = sum_partial();
+    }
+
+    if (config.kernels & STREAM_GATHER) {
+      t0 = kernel_begin(7, k, me);
+      s = 0.0;
+      for (j = lo; j < hi; j++)
+        s += a[idx[j]];
+      partial[me] = s;
+      kernel_end(7, k, me, t0);
+      if (me == 0)
+        reduced[2] = sum_partial();
+    }
   }
+  barrier(me);
+}
+
+static int stream_report() {
+  STREAM_TYPE *vptr[] = {a, b, c};
+  double times[NKERNELS][NTIMES_MAX];
+  bench_perf perf = {.valid = kperf[0][0].valid};
+  uint64_t cycles;
+  size_t j;
+  int k;
 
   /*	--- SUMMARY --- */
 
-  for (k = 1; k < NTIMES; k++) /* note -- skip first iteration */
+  for (k = 0; k < ntimes; k++)
+    for (j = 0; j < NKERNELS; j++)
+      times[j][k] = 1.0E-6 * kperf[j][k].time;
+
+  if (ncpu > 1) {
+    printf("Harts: %d, best MB/s of every hart on its part of the arrays\n",
+           ncpu);
+    printf("Hart     ");
+    for (j = 0; j < NKERNELS; j++)
+      if (KERNEL_ON(j))
+        printf("%8.7s", label[j]);
+    printf("\n");
+    for (k = 0; k < ncpu; k++) {
+      double share = (double)(asize * (k + 1) / ncpu - asize * k / ncpu) / asize;
+      printf("%9d", k);
+      for (j = 0; j < NKERNELS; j++)
+        if (KERNEL_ON(j))
+          printf("%8.0f", rate(share * bytes[j], 1.0E-6 * hart_time[k][j]));
+      printf("\n");
+    }
+    printf(HLINE);
+  }
+
+  printf("Iteration");
+  for (j = 0; j < NKERNELS; j++)
+    if (KERNEL_ON(j))
+      printf("%8.7s", label[j]);
+  printf("  (MB/s)\n");
+  for (k = 0; k < ntimes; k++) {
+    printf("%9d", k);
+    for (j = 0; j < NKERNELS; j++)
+      if (KERNEL_ON(j))
+        printf("%8.0f", rate(bytes[j], times[j][k]));
+    printf(k == 0 ? "  (warm-up)\n" : "\n");
+  }
+  printf(HLINE);
+
+  for (k = 1; k < ntimes; k++) /* note -- skip first iteration */
   {
-    for (j = 0; j < 4; j++) {
+    for (j = 0; j < NKERNELS; j++) {
       avgtime[j] = avgtime[j] + times[j][k];
       mintime[j] = MIN(mintime[j], times[j][k]);
       maxtime[j] = MAX(maxtime[j], times[j][k]);
     }
   }
 
-  printf("Function    Best Rate MB/s  Avg time     Min time     Max time\n");
-  for (j = 0; j < 4; j++) {
-    avgtime[j] = avgtime[j] / (double)(NTIMES - 1);
-
-    printf("%s%12.1f  %11.6f  %11.6f  %11.6f\n", label[j],
-           1.0E-06 * bytes[j] / mintime[j], avgtime[j], mintime[j], maxtime[j]);
+  printf("Function    Best Rate MB/s  Avg Rate MB/s  Worst Rate MB/s"
+         "  Avg time     Min time     Max time");
+  printf(perf.valid & BENCH_PERF_CYCLES ? "  Best B/cycle\n" : "\n");
+  for (j = 0; j < NKERNELS; j++) {
+    avgtime[j] = avgtime[j] / (double)(ntimes - 1);
+    if (!KERNEL_ON(j))
+      continue;
+
+    printf("%s%12.1f  %13.1f  %15.1f  %11.6f  %11.6f  %11.6f", label[j],
+           rate(bytes[j], mintime[j]), rate(bytes[j], avgtime[j]),
+           rate(bytes[j], maxtime[j]), avgtime[j], mintime[j], maxtime[j]);
+    if (perf.valid & BENCH_PERF_CYCLES) {
+      cycles = UINT64_MAX;
+      for (k = 1; k < ntimes; k++)
+        cycles = MIN(cycles, kperf[j][k].cycles);
+      printf("  %12.3f", cycles ? bytes[j] / cycles : 0.0);
+    }
+    printf("\n");
   }
   printf(HLINE);
 
   /* --- Check Results --- */
-  checkSTREAMresults(asize, &vptr);
+  checkSTREAMresults(asize, vptr, ntimes);
   printf(HLINE);
 
-  double total_time = avgtime[0] + avgtime[1] + avgtime[2] + avgtime[3];
+  uint32_t sums[3];
+  for (j = 0; j < 3; j++)
+    sums[j] = checksum(vptr[j], vptr[j] + asize);
+  uint32_t sum = checksum(sums, sums + 3);
 
-  BENCH_LOG(INFO, "OpenPerf time: %s",
-            format_time((uint64_t)(total_time * 1000)));
+#ifdef STREAM_SWEEP
+  stream_sweep(ntimes);
+#endif
+
+  /* the time is the sum of the average run of every kernel, and so are the
+   * counters, so that they describe the same span */
+  double total_time = 0;
+  for (j = 0; j < NKERNELS; j++)
+    total_time += avgtime[j];
+  if (idx)
+    bench_free(idx);
+  perf.time = (uint64_t)(total_time * 1.0E6);
+  for (j = 0; j < NKERNELS; j++) {
+    for (k = 1; k < ntimes; k++) {
+      perf.cycles += kperf[j][k].cycles;
+      perf.instret += kperf[j][k].instret;
+    }
+  }
+  perf.cycles /= ntimes - 1;
+  perf.instret /= ntimes - 1;
+
+  BENCH_LOG(INFO, "OpenPerf time: %s%s", format_time(perf.time),
+            format_counters(&perf));
+  bench_malloc_report();
+  bench_result("stream", asize, sum, &perf);
 
-  return 0;
+  return bench_verify(sum);
 }
 
+#ifdef STREAM_SWEEP
+/* Memory-hierarchy sweep: the four kernels at working sets (all three arrays)
+ * doubling from config.sweep_min to config.sweep_max KiB, so every cache
+ * level's bandwidth shows up in one run. Small arrays repeat each kernel so
+ * that every sample moves as many bytes as the largest size does. Each kernel
+ * is idempotent on its own, so the repetitions leave the values bounded.
+ */
+#define SWEEP_TIME(t, stmt)                                                    \
+  do {                                                                         \
+    double __t0 = mysecond();                                                  \
+    for (r = 0; r < reps; r++) {                                               \
+      for (j = 0; j < n; j++)                                                  \
+        stmt;                                                                  \
+      __asm__ __volatile__("" ::: "memory");                                   \
+    }                                                                          \
+    t = (mysecond() - __t0) / reps;                                            \
+  } while (0)
+
+static void stream_sweep(int ntimes) {
+  if (config.sweep_min == 0 || config.sweep_max < config.sweep_min) {
+    BENCH_LOG(WARN, "No sweep range for this input");
+    return;
+  }
+  size_t nmax = config.sweep_max * 1024 / (3 * sizeof(STREAM_TYPE));
+  STREAM_TYPE *a = bench_malloc(sizeof(STREAM_TYPE) * nmax);
+  STREAM_TYPE *b = bench_malloc(sizeof(STREAM_TYPE) * nmax);
+  STREAM_TYPE *c = bench_malloc(sizeof(STREAM_TYPE) * nmax);
+  STREAM_TYPE scalar = 3.0;
+  double t[4], best[4];
+  size_t j, r;
+  int k;
+
+  printf(HLINE);
+  printf("Sweep (best rate MB/s)\n");
+  printf("Working set   Copy         Scale        Add          Triad\n");
+  for (unsigned int kib = config.sweep_min; kib <= config.sweep_max;
+       kib *= 2) {
+    size_t n = kib * 1024 / (3 * sizeof(STREAM_TYPE));
+    size_t reps = nmax / n;
+    double bytes[4] = {
+        2 * sizeof(STREAM_TYPE) * n, 2 * sizeof(STREAM_TYPE) * n,
+        3 * sizeof(STREAM_TYPE) * n, 3 * sizeof(STREAM_TYPE) * n};
+
+    for (j = 0; j < n; j++) {
+      a[j] = 1.0;
+      b[j] = 2.0;
+      c[j] = 0.0;
+    }
+    for (j = 0; j < 4; j++)
+      best[j] = FLT_MAX;
+    for (k = 0; k < ntimes; k++) {
+      SWEEP_TIME(t[0], c[j] = a[j]);
+      SWEEP_TIME(t[1], b[j] = scalar * c[j]);
+      SWEEP_TIME(t[2], c[j] = a[j] + b[j]);
+      SWEEP_TIME(t[3], a[j] = b[j] + scalar * c[j]);
+      for (j = 0; k > 0 && j < 4; j++) /* skip the first iteration */
+        best[j] = MIN(best[j], t[j]);
+    }
+
+    printf("%7d KiB", kib);
+    for (j = 0; j < 4; j++)
+      printf("  %11.1f", best[j] > 0 ? 1.0E-06 * bytes[j] / best[j] : 0.0);
+    printf("\n");
+  }
+  printf(HLINE);
+
+  bench_free(a);
+  bench_free(b);
+  bench_free(c);
+}
+#endif
+
 #define M 20
 
 int checktick() {
@@ -430,12 +765,18 @@ int checktick() {
 /* This function has been modified from the original version to ensure
  * ANSI compliance, due to the deprecation of the "timezone" struct. */
 
-double mysecond() { return ((double)uptime() / 1000); }
+double mysecond() { return 1.0E-6 * uptime(); }
+
+/* MB/s of `bytes` moved in `t` seconds, 0 if the kernel was below the timer
+ * resolution */
+static double rate(double bytes, double t) {
+  return t > 0 ? 1.0E-06 * bytes / t : 0.0;
+}
 
 #ifndef abs
 #define abs(a) ((a) >= 0 ? (a) : -(a))
 #endif
-void checkSTREAMresults(int asize, STREAM_TYPE **vptr) {
+void checkSTREAMresults(int asize, STREAM_TYPE **vptr, int ntimes) {
   assert(vptr);
   STREAM_TYPE aj, bj, cj, scalar;
   STREAM_TYPE aSumErr, bSumErr, cSumErr;
@@ -452,11 +793,13 @@ void checkSTREAMresults(int asize, STREAM_TYPE **vptr) {
   aj = 2.0E0 * aj;
   /* now execute timing loop */
   scalar = 3.0;
-  for (k = 0; k < NTIMES; k++) {
+  for (k = 0; k < ntimes; k++) {
     cj = aj;
     bj = scalar * cj;
     cj = aj + bj;
     aj = bj + scalar * cj;
+    if (config.kernels & STREAM_FILL)
+      cj = scalar;
   }
 
   /* accumulate deltas between observed and expected results */
@@ -549,6 +892,17 @@ void checkSTREAMresults(int asize, STREAM_TYPE **vptr) {
     }
     printf("     For array c[], %d errors were found.\n", ierr);
   }
+  /* Sum, Stride and Gather add the same values in different orders */
+  for (k = 0; k < 3; k++) {
+    int r = reduce_kernel[k];
+    if (!KERNEL_ON(r))
+      continue;
+    if (abs(reduced[k] / (aj * asize) - 1.0) > epsilon * asize) {
+      err++;
+      printf("Failed Validation on %s expected: %e, observed: %e\n", label[r],
+             aj * asize, reduced[k]);
+    }
+  }
   if (err == 0) {
     printf("Solution Validates: avg error less than %e on all three arrays\n",
            epsilon);
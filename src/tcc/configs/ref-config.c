@@ -1,3 +1,4 @@
+#include <bench.h>
 #include "../config.h"
 #include <fs.h>
 
@@ -16,3 +17,6 @@ char *tcc_argv1[] = {
 };
 
 bench_tcc_config config = {.file_count = 4};
+
+Setting bench_setting = {.sub_config = &config, .checksum = 0x7ceb75ec,
+                         .ref_time = 312};
@@ -1,3 +1,4 @@
+#include <bench.h>
 #include "../config.h"
 #include <fs.h>
 
@@ -13,3 +14,6 @@ char *tcc_argv1[] = {
     "-O2",       "-static"};
 
 bench_tcc_config config = {3};
+
+Setting bench_setting = {.sub_config = &config, .checksum = 0x8276785a,
+                         .ref_time = 350};
@@ -1,3 +1,4 @@
+#include <bench.h>
 #include "../config.h"
 #include <fs.h>
 
@@ -14,3 +15,5 @@ char *tcc_argv1[] = {
     "-O2",       "-static"};
 
 bench_tcc_config config = {4};
+
+Setting bench_setting = {.sub_config = &config, .ref_time = 618};
@@ -144,7 +144,7 @@ PUB_FUNC void *tcc_mallocz(unsigned long size) {
   void *ptr;
   ptr = tcc_malloc(size);
   if (size)
-    memset(ptr, 0, size);
+    bench_memset(ptr, 0, size);
   return ptr;
 }
 
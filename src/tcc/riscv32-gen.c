@@ -684,6 +684,7 @@ ST_FUNC void gfunc_call(int nb_args) {
     gbound_args(nb_args);
 #endif
 
+  BENCH_REGION_START("codegen");
   areg[0] = 0; /* int arg regs */
   areg[1] = 8; /* float arg regs */
   sa = vtop[-nb_args].type.ref->next;
@@ -894,6 +895,7 @@ ST_FUNC void gfunc_call(int nb_args) {
     }
   }
   tcc_free(info);
+  BENCH_REGION_STOP("codegen");
 }
 
 static int func_sub_sp_offset, num_va_regs, func_va_list_ofs;
@@ -71,6 +71,31 @@ static char *default_outputfile(TCCState *s, const char *first_file) {
 
 extern bench_tcc_config config;
 
+/* bytes of C sources and headers in the file table, the input size of the
+   result record */
+static uint64_t source_size(Finfo *files, int count) {
+  uint64_t size = 0;
+  for (int i = 0; i < count; i++) {
+    const char *ext = tcc_fileextension(files[i].name);
+    if (!strcmp(ext, ".c") || !strcmp(ext, ".h"))
+      size += files[i].size;
+  }
+  return size;
+}
+
+/* checksum of a file as it is in the ramdisk, i.e. of the compiler output */
+static uint32_t checksum_file(const char *name) {
+  int fd = fs_open(name, 0, 0);
+  size_t size = fs_lseek(fd, 0, SEEK_END);
+  uint8_t *buf = bench_malloc(size);
+  fs_lseek(fd, 0, SEEK_SET);
+  fs_read(fd, buf, size);
+  fs_close(fd);
+  uint32_t sum = checksum(buf, buf + size);
+  bench_free(buf);
+  return sum;
+}
+
 int main(int argc0, char **argv0) {
 
   extern Finfo file_table[];
@@ -78,7 +103,8 @@ int main(int argc0, char **argv0) {
   bench_malloc_init();
   TCCState *s, *s1;
   int ret, opt, n = 0, t = 0, done;
-  uint64_t start_time = 0, end_time = 0;
+  bench_perf start, perf;
+  uint32_t sum = 0;
   const char *first_file;
   int argc;
   char **argv;
@@ -86,7 +112,7 @@ int main(int argc0, char **argv0) {
 
   extern int tcc_argc1;
   extern char *tcc_argv1[];
-  start_time = uptime();
+  bench_perf_begin(&start);
 redo:
   argc = tcc_argc1, argv = tcc_argv1;
   s = s1 = tcc_new();
@@ -155,7 +181,8 @@ redo:
     done = ret || ++n >= s->nb_files;
   } while (!done && (s->output_type != TCC_OUTPUT_OBJ || s->option_r));
 
-  end_time = uptime();
+  perf = start;
+  bench_perf_end(&perf);
 
   if (s->run_test) {
     t = 0;
@@ -169,15 +196,19 @@ redo:
     } else {
       if (!s->outfile)
         s->outfile = default_outputfile(s, first_file);
+      BENCH_REGION_START("elf");
       if (!s->just_deps && tcc_output_file(s, s->outfile))
         ret = 1;
+      BENCH_REGION_STOP("elf");
+      if (!ret && !s->just_deps)
+        sum = checksum_file(s->outfile);
       // else if (s->gen_deps)
       //     gen_makedeps(s, s->outfile, s->deps_outfile);
     }
   }
 
   if (done && 0 == t && 0 == ret && s->do_bench)
-    tcc_print_stats(s, end_time - start_time);
+    tcc_print_stats(s, perf.time);
 
   tcc_delete(s);
   if (!done)
@@ -187,6 +218,12 @@ redo:
 
   // if (ppfp && ppfp != stdout)
   //     fclose(ppfp);
-  BENCH_LOG(INFO, "OpenPerf time: %s", format_time(end_time - start_time));
-  return ret;
+  BENCH_LOG(INFO, "OpenPerf time: %s%s", format_time(perf.time),
+            format_counters(&perf));
+  bench_malloc_report();
+  bench_region_report();
+  bench_result("tcc", source_size(file_table, config.file_count), sum, &perf);
+  if (ret)
+    return ret;
+  return bench_verify(sum);
 }
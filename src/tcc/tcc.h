@@ -34,6 +34,7 @@
 #include <bench.h>
 #include <bench_debug.h>
 #include <bench_malloc.h>
+#include <bench_mem.h>
 #include <bench_strings.h>
 #include <fs.h>
 // #include <stdlib.h>
@@ -378,9 +378,11 @@ ST_FUNC int tccgen_compile(TCCState *s1) {
   printf("%s: **** new file\n", file->filename);
 #endif
   parse_flags = PARSE_FLAG_PREPROCESS | PARSE_FLAG_TOK_NUM | PARSE_FLAG_TOK_STR;
+  BENCH_REGION_START("parse");
   next();
   decl(VT_CONST);
   gen_inline_functions(s1);
+  BENCH_REGION_STOP("parse");
   check_vstack();
   /* end of translation unit info */
   tcc_debug_end(s1);
@@ -1620,6 +1622,7 @@ ST_FUNC int gv(int rc) {
   int r, r2, r_ok, r2_ok, rc2, bt;
   int bit_pos, bit_size, size, align;
 
+  BENCH_REGION_START("codegen");
   /* NOTE: get_reg can modify vstack[] */
   if (vtop->type.t & VT_BITFIELD) {
     CType type;
@@ -1758,6 +1761,7 @@ ST_FUNC int gv(int rc) {
       vtop->r2 = r + 1;
 #endif
   }
+  BENCH_REGION_STOP("codegen");
   return r;
 }
 
@@ -2785,6 +2789,7 @@ ST_FUNC void gen_op(int op) {
   int t1, t2, bt1, bt2, t;
   CType type1, combtype;
 
+  BENCH_REGION_START("codegen");
 redo:
   t1 = vtop[-1].type.t;
   t2 = vtop[0].type.t;
@@ -2912,6 +2917,7 @@ redo:
   // Make sure that we have converted to an rvalue:
   if (vtop->r & VT_LVAL)
     gv(is_float(vtop->type.t & VT_BTYPE) ? RC_FLOAT : RC_INT);
+  BENCH_REGION_STOP("codegen");
 }
 
 #if defined TCC_TARGET_ARM64 || defined TCC_TARGET_RISCV64 ||                  \
@@ -3422,6 +3428,7 @@ static void gen_assign_cast(CType *dt) {
 ST_FUNC void vstore(void) {
   int sbt, dbt, ft, r, size, align, bit_size, bit_pos, delayed_cast;
 
+  BENCH_REGION_START("codegen");
   ft = vtop[-1].type.t;
   sbt = vtop->type.t & VT_BTYPE;
   dbt = ft & VT_BTYPE;
@@ -3589,6 +3596,7 @@ ST_FUNC void vstore(void) {
     vswap();
     vtop--; /* NOT vpop() because on x86 it would flush the fp stack */
   }
+  BENCH_REGION_STOP("codegen");
 }
 
 /* post defines POST/PRE add. c is the token ++ or -- */
@@ -3515,8 +3515,8 @@ static void next_nomacro(void) {
   }
 }
 
-/* return next token with macro substitution */
-ST_FUNC void next(void) {
+/* next token with macros expanded, without the region timer */
+static void next_expand(void) {
   int t;
 redo:
   next_nomacro();
@@ -3559,6 +3559,13 @@ redo:
   }
 }
 
+/* return next token with macro substitution */
+ST_FUNC void next(void) {
+  BENCH_REGION_START("preprocess");
+  next_expand();
+  BENCH_REGION_STOP("preprocess");
+}
+
 /* push back current token and set current token to 'last_tok'. Only
    identifier case handled for labels. */
 ST_INLN void unget_tok(int last_tok) {
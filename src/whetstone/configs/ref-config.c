@@ -1,3 +1,7 @@
+#include <bench.h>
 #include <whestone.h>
 
 bench_whestone_config config = {200};
+
+Setting bench_setting = {.sub_config = &config, .checksum = 0xa269ed6d,
+                         .ref_time = 10596, .repeat_time = 3, .warmup_time = 1};
@@ -1,3 +1,7 @@
+#include <bench.h>
 #include <whestone.h>
 
 bench_whestone_config config = {30};
+
+Setting bench_setting = {.sub_config = &config, .checksum = 0x967e506e,
+                         .ref_time = 1629, .repeat_time = 5, .warmup_time = 1};
@@ -1,3 +1,7 @@
+#include <bench.h>
 #include <whestone.h>
 
 bench_whestone_config config = {10};
+
+Setting bench_setting = {.sub_config = &config, .checksum = 0x2de82ecf,
+                         .ref_time = 697, .repeat_time = 5, .warmup_time = 1};
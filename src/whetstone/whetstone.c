@@ -66,31 +66,50 @@ double T, T1, T2, E1[5];
 int J, K, L;
 
 extern bench_whestone_config config;
-int main(int argc, char *argv[]) {
+
+/* final values of all modules, for the output checksum */
+static double results[16];
+static long LOOP;
+static int II;
+
+/*
+  The timed modules: iterations per LOOP (as N2..N11 below) and operations
+  per iteration, floating-point for the MFLOPS ones. Modules 1 and 10 run no
+  iterations and are left out.
+*/
+enum { M_ARRAY, M_PARAM, M_COND, M_INT, M_TRIG, M_CALL, M_REF, M_LIBM };
+static const struct {
+  const char *name;
+  const char *unit;
+  int n;
+  int ops;
+} modules[] = {
+    [M_ARRAY] = {"array", "MFLOPS", 12, 16},
+    [M_PARAM] = {"param", "MFLOPS", 14, 96},
+    [M_COND] = {"cond", "MOPS", 345, 3},
+    [M_INT] = {"int", "MOPS", 210, 15},
+    [M_TRIG] = {"trig", "MOPS", 32, 26},
+    [M_CALL] = {"call", "MFLOPS", 899, 6},
+    [M_REF] = {"ref", "MOPS", 616, 3},
+    [M_LIBM] = {"libm", "MOPS", 93, 4},
+};
+
+/* time of every module in the current run, and in the fastest run so far */
+static uint64_t module_run[LENGTH(modules)];
+static uint64_t module_time[LENGTH(modules)];
+static uint64_t module_start;
+
+#define MODULE_BEGIN() (module_start = uptime())
+#define MODULE_END(m) (module_run[m] += uptime() - module_start)
+
+/* one measured run of all modules, repeated by bench_repeat() */
+static void whetstone(void *arg) {
   /* used in the FORTRAN version */
   long I1;
   long N1, N2, N3, N4, N6, N7, N8, N9, N10, N11;
   double X1, X2, X3, X4, X, Y, Z;
-  long LOOP;
-  int II, JJ;
-
-  /* added for this version */
-  long loopstart;
-  uint64_t startsec, finisec;
-  float KIPS;
-  int continuous;
-
-  // loopstart = 1000;		/* see the note about LOOP below */
-  loopstart = config.loopstart;
-  continuous = 0;
-
-LCONT:
-  /*
-  C
-  C	Start benchmark timing at this point.
-  C
-  */
-  startsec = uptime();
+  double X7, Y7;
+  int JJ;
 
   /*
   C
@@ -108,10 +127,12 @@ LCONT:
   C
           LOOP = 1000;
   */
-  LOOP = loopstart;
+  LOOP = config.loopstart;
   II = 1;
 
   JJ = 1;
+  for (int m = 0; m < LENGTH(modules); m++)
+    module_run[m] = 0;
 
 IILOOP:
   N1 = 0;
@@ -154,12 +175,14 @@ IILOOP:
   E1[3] = -1.0;
   E1[4] = -1.0;
 
+  MODULE_BEGIN();
   for (I1 = 1; I1 <= N2; I1++) {
     E1[1] = (E1[1] + E1[2] + E1[3] - E1[4]) * T;
     E1[2] = (E1[1] + E1[2] - E1[3] + E1[4]) * T;
     E1[3] = (E1[1] - E1[2] + E1[3] + E1[4]) * T;
     E1[4] = (-E1[1] + E1[2] + E1[3] + E1[4]) * T;
   }
+  MODULE_END(M_ARRAY);
 
 #ifdef PRINTOUT
   IF(JJ == II) POUT(N2, N3, N2, E1[1], E1[2], E1[3], E1[4]);
@@ -170,8 +193,10 @@ IILOOP:
   C	Module 3: Array as parameter
   C
   */
+  MODULE_BEGIN();
   for (I1 = 1; I1 <= N3; I1++)
     PA(E1);
+  MODULE_END(M_PARAM);
 
 #ifdef PRINTOUT
   IF(JJ == II) POUT(N3, N2, N2, E1[1], E1[2], E1[3], E1[4]);
@@ -183,6 +208,7 @@ IILOOP:
   C
   */
   J = 1;
+  MODULE_BEGIN();
   for (I1 = 1; I1 <= N4; I1++) {
     if (J == 1)
       J = 2;
@@ -199,6 +225,7 @@ IILOOP:
     else
       J = 0;
   }
+  MODULE_END(M_COND);
 
 #ifdef PRINTOUT
   IF(JJ == II) POUT(N4, J, J, X1, X2, X3, X4);
@@ -215,6 +242,7 @@ IILOOP:
   K = 2;
   L = 3;
 
+  MODULE_BEGIN();
   for (I1 = 1; I1 <= N6; I1++) {
     J = J * (K - J) * (L - K);
     K = L * K - (L - J) * K;
@@ -222,6 +250,7 @@ IILOOP:
     E1[L - 1] = J + K + L;
     E1[K - 1] = J * K * L;
   }
+  MODULE_END(M_INT);
 
 #ifdef PRINTOUT
   IF(JJ == II) POUT(N6, J, K, E1[1], E1[2], E1[3], E1[4]);
@@ -235,14 +264,18 @@ IILOOP:
   X = 0.5;
   Y = 0.5;
 
+  MODULE_BEGIN();
   for (I1 = 1; I1 <= N7; I1++) {
     X = T * DATAN(T2 * DSIN(X) * DCOS(X) / (DCOS(X + Y) + DCOS(X - Y) - 1.0));
     Y = T * DATAN(T2 * DSIN(Y) * DCOS(Y) / (DCOS(X + Y) + DCOS(X - Y) - 1.0));
   }
+  MODULE_END(M_TRIG);
 
 #ifdef PRINTOUT
   IF(JJ == II) POUT(N7, J, K, X, X, Y, Y);
 #endif
+  X7 = X;
+  Y7 = Y;
 
   /*
   C
@@ -253,8 +286,10 @@ IILOOP:
   Y = 1.0;
   Z = 1.0;
 
+  MODULE_BEGIN();
   for (I1 = 1; I1 <= N8; I1++)
     P3(X, Y, &Z);
+  MODULE_END(M_CALL);
 
 #ifdef PRINTOUT
   IF(JJ == II) POUT(N8, J, K, X, Y, Z, Z);
@@ -272,8 +307,10 @@ IILOOP:
   E1[2] = 2.0;
   E1[3] = 3.0;
 
+  MODULE_BEGIN();
   for (I1 = 1; I1 <= N9; I1++)
     P0();
+  MODULE_END(M_REF);
 
 #ifdef PRINTOUT
   IF(JJ == II) POUT(N9, J, K, E1[1], E1[2], E1[3], E1[4]);
@@ -305,8 +342,10 @@ IILOOP:
   */
   X = 0.75;
 
+  MODULE_BEGIN();
   for (I1 = 1; I1 <= N11; I1++)
     X = DSQRT(DEXP(DLOG(X) / T1));
+  MODULE_END(M_LIBM);
 
 #ifdef PRINTOUT
   IF(JJ == II) POUT(N11, J, K, X, X, X, X);
@@ -320,12 +359,36 @@ IILOOP:
   if (++JJ <= II)
     goto IILOOP;
 
+  double final[] = {X1,    X2,    X3, X4, E1[1], E1[2], E1[3], E1[4],
+                    X7,    Y7,    X,  Y,  Z,     J,     K,     L};
+  for (int i = 0; i < LENGTH(results); i++)
+    results[i] = final[i];
+  for (int m = 0; m < LENGTH(modules); m++) {
+    if (module_time[m] == 0 || module_run[m] < module_time[m])
+      module_time[m] = module_run[m];
+  }
+}
+
+int main(int argc, char *argv[]) {
+  /* added for this version */
+  long loopstart;
+  bench_perf perf;
+  double MWIPS;
+  int continuous;
+
+  // loopstart = 1000;		/* see the note about LOOP below */
+  loopstart = config.loopstart;
+  continuous = 0;
+
+LCONT:
   /*
   C
-  C      Stop benchmark timing at this point.
+  C	Timed runs of the benchmark, see bench_repeat().
   C
   */
-  finisec = uptime();
+  bench_repeat(NULL, whetstone, NULL, &perf);
+
+  uint32_t sum = checksum(results, results + LENGTH(results));
 
   /*
   C----------------------------------------------------------------
@@ -337,26 +400,40 @@ IILOOP:
   C--------------------------------------------------------------------
   */
   printf("\n");
-  if (finisec - startsec <= 0) {
+  if (perf.time <= 0) {
     printf("Insufficient duration- Increase the LOOP count\n");
     return (1);
   }
 
-  printf("Loops: %ld, Iterations: %d, Duration: %ld sec.\n", LOOP, II,
-         finisec - startsec);
+  printf("Loops: %ld, Iterations: %d, Duration: %llu us.\n", LOOP, II,
+         perf.time);
+
+  /* 100000 Whetstone instructions per LOOP, so MWIPS = 0.1 * LOOP * II / s */
+  MWIPS = 100000.0 * LOOP * II / perf.time;
+  printf("C Converted Double Precision Whetstones: %.1f MWIPS\n", MWIPS);
 
-  KIPS = (100.0 * LOOP * II) / (float)(finisec - startsec);
-  if (KIPS >= 1000.0)
-    printf("C Converted Double Precision Whetstones: %.1f MWIPS\n",
-           KIPS / 1000.0);
-  else
-    printf("C Converted Double Precision Whetstones: %.1f KWIPS\n", KIPS);
+  printf("Module    Time(us)        Rate\n");
+  for (int m = 0; m < LENGTH(modules); m++) {
+    double ops = (double)modules[m].n * LOOP * II * modules[m].ops;
+    printf("%-8s  %8llu", modules[m].name, module_time[m]);
+    if (module_time[m])
+      printf("  %10.2f %s\n", ops / module_time[m], modules[m].unit);
+    else
+      printf("  %10s\n", "-");
+    bench_result_field(module_time[m], "module.%s.time_us", modules[m].name);
+    if (module_time[m])
+      bench_result_field(ops / module_time[m], "module.%s.mops",
+                         modules[m].name);
+  }
 
   if (continuous)
     goto LCONT;
 
-  BENCH_LOG(INFO, "OpenPerf time: %s", format_time(finisec - startsec));
-  return 0;
+  BENCH_LOG(INFO, "OpenPerf time: %s%s", format_time(perf.time),
+            format_counters(&perf));
+  bench_result_ops(100000ull * LOOP * II);
+  bench_result("whetstone", loopstart, sum, &perf);
+  return bench_verify(sum);
 }
 
 void PA(double E[]) {
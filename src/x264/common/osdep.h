@@ -39,6 +39,7 @@
 #include <openlibm.h>
 #include <inttypes.h>
 #include <x264.h>
+#include <bench.h>
 #include <bench_malloc.h>
 #include <bench_debug.h>
 #include <bench_strings.h>
@@ -1,6 +1,10 @@
+#include <bench.h>
 #include <fs.h>
 #include <x264.h>
 
 bench_x264_config config = {256, 80, 24, 2};
 Finfo filelist[] = {{"/share/video/bad-apple.yuv", 1843200, 0, NULL, NULL},
                     {"/share/video/out.h264", 409600, 1843200, NULL, NULL}};
+
+Setting bench_setting = {.sub_config = &config, .checksum = 0xf3b5f2e2,
+                         .ref_time = 67539};
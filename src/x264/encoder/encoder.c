@@ -2380,8 +2380,12 @@ static void fdec_filter_row( x264_t *h, int mb_y, int pass )
         return;
 
     if( b_deblock )
+    {
+        BENCH_REGION_START( "deblock" );
         for( int y = min_y; y < mb_y; y += (1 << SLICE_MBAFF) )
             x264_frame_deblock_row( h, y );
+        BENCH_REGION_STOP( "deblock" );
+    }
 
     /* FIXME: Prediction requires different borders for interlaced/progressive mc,
      * but the actual image data is equivalent. For now, maintain this
@@ -2784,7 +2788,9 @@ static intptr_t slice_write( x264_t *h )
         else
             x264_macroblock_cache_load_progressive( h, i_mb_x, i_mb_y );
 
+        BENCH_REGION_START( "analyse" );
         x264_macroblock_analyse( h );
+        BENCH_REGION_STOP( "analyse" );
 
         /* encode this macroblock -> be careful it can change the mb type to P_SKIP if needed */
 reencode:
@@ -2801,7 +2807,9 @@ reencode:
             {
                 if( h->sh.i_type != SLICE_TYPE_I )
                     x264_cabac_mb_skip( h, 0 );
+                BENCH_REGION_START( "cabac" );
                 x264_macroblock_write_cabac( h, &h->cabac );
+                BENCH_REGION_STOP( "cabac" );
             }
         }
         else
@@ -15,7 +15,8 @@ int main(const char *args) {
   bench_malloc_init();
   fs_init(filelist, config.files_num);
 
-  uint64_t start_time = uptime(), end_time = ULLONG_MAX;
+  bench_perf perf;
+  bench_perf_begin(&perf);
   int width = config.width;
   int height = config.height;
   int fps = config.fps;
@@ -64,18 +65,21 @@ int main(const char *args) {
     }
   }
   x264_encoder_close(encoder);
-  end_time = uptime();
+  bench_perf_end(&perf);
   bench_free(yuv_buffer);
   uint32_t total = fs_lseek(output, 0, SEEK_CUR);
 
   extern char output_start;
+  uint32_t sum = checksum(&output_start, (uint8_t *)&output_start + total);
   bench_printf("total: %d\n", total);
-  bench_printf("Checksum is %#x\n",
-               checksum(&output_start, (uint8_t *)&output_start + total));
-  BENCH_LOG(INFO, "OpenPerf time: %s", format_time(end_time - start_time));
+  BENCH_LOG(INFO, "OpenPerf time: %s%s", format_time(perf.time),
+            format_counters(&perf));
+  bench_malloc_report();
+  bench_region_report();
+  bench_result("x264", i_pts * yuv_size, sum, &perf);
 
   fs_close(input);
   fs_close(output);
 
-  return 0;
+  return bench_verify(sum);
 }